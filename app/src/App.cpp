@@ -2,13 +2,27 @@
 
 App::App()
 {
+    std::chrono::steady_clock::time_point StartupStartTime = std::chrono::steady_clock::now();
     Init();
     CreateDescriptorSetLayout();
+    // 管线在工作线程上编译，同时继续加载模型与纹理
     CreatePipeline();
     CreateCamera();
+    // 模型与纹理的传输记录到同一批次，统一提交后等待一次
+    uint64_t UploadTicket = 0;
+    mDevice->GetUploader()->Begin();
     CreateModelBuffer();
+    mDevice->GetUploader()->End(&UploadTicket);
+    mDevice->GetUploader()->Wait(UploadTicket);
     CreateShaderBuffer();
     WriteShaderBuffer();
+    // 等待管线编译完成，管线耗时为各管线编译耗时之和，与同时进行的资源加载无关，可以对比管线缓存的效果
+    WaitPipeline();
+    for (auto &&i : mPipelineBuilder->GetBuildRecordList())
+    {
+        mPipelineCreateTime += i.BuildTime;
+    }
+    mStartupTime = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::steady_clock::now() - StartupStartTime).count();
 }
 App::~App()
 {
@@ -16,10 +30,11 @@ App::~App()
 void App::Init()
 {
     vk::Window::Init();
+    mJobSystem = vk::JobSystem::New();
     SDL_Rect Rect = vk::Window::GetDisplayBound(0);
     mWindow = vk::Window::New("VulkanEngine", 1600, 900, false, true);
     mDevice = vk::Device::New(mWindow);
-    mRenderer = vk::Renderer::New(mDevice);
+    mRenderer = vk::Renderer::New(mDevice, mJobSystem);
     mGui = vk::Gui::New(mDevice, mWindow);
 }
 void App::CreateDescriptorSetLayout()
@@ -42,18 +57,30 @@ void App::CreateDescriptorSetLayout()
         VkDescriptorSetLayoutBinding ModelSpaceDescriptorSetLayoutBinding{};
         ModelSpaceDescriptorSetLayoutBinding.binding = 12;
         ModelSpaceDescriptorSetLayoutBinding.descriptorCount = 1;
-        ModelSpaceDescriptorSetLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        ModelSpaceDescriptorSetLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         ModelSpaceDescriptorSetLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-        // 光缓冲区描述
+        // 光缓冲区描述，存放全部点光数据，广告牌按实例索引读取
         VkDescriptorSetLayoutBinding SpotLightDescriptorSetLayoutBinding{};
         SpotLightDescriptorSetLayoutBinding.binding = 13;
         SpotLightDescriptorSetLayoutBinding.descriptorCount = 1;
-        SpotLightDescriptorSetLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        SpotLightDescriptorSetLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-        // 纹理描述
+        SpotLightDescriptorSetLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        SpotLightDescriptorSetLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        // 每个绘制的数据描述
+        VkDescriptorSetLayoutBinding DrawDataDescriptorSetLayoutBinding{};
+        DrawDataDescriptorSetLayoutBinding.binding = 14;
+        DrawDataDescriptorSetLayoutBinding.descriptorCount = 1;
+        DrawDataDescriptorSetLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        DrawDataDescriptorSetLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        // 纹理流送反馈描述
+        VkDescriptorSetLayoutBinding TextureFeedbackDescriptorSetLayoutBinding{};
+        TextureFeedbackDescriptorSetLayoutBinding.binding = 15;
+        TextureFeedbackDescriptorSetLayoutBinding.descriptorCount = 1;
+        TextureFeedbackDescriptorSetLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        TextureFeedbackDescriptorSetLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+        // 纹理数组描述
         VkDescriptorSetLayoutBinding TextureDescriptorSetLayoutBinding{};
         TextureDescriptorSetLayoutBinding.binding = 0;
-        TextureDescriptorSetLayoutBinding.descriptorCount = 1;
+        TextureDescriptorSetLayoutBinding.descriptorCount = mMaxTextureCount;
         TextureDescriptorSetLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
         TextureDescriptorSetLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
         // 创建描述符布局
@@ -63,6 +90,8 @@ void App::CreateDescriptorSetLayout()
                                                                     IlluminationDescriptorSetLayoutBinding,
                                                                     ModelSpaceDescriptorSetLayoutBinding,
                                                                     SpotLightDescriptorSetLayoutBinding,
+                                                                    DrawDataDescriptorSetLayoutBinding,
+                                                                    TextureFeedbackDescriptorSetLayoutBinding,
                                                                     TextureDescriptorSetLayoutBinding,
                                                                 },
                                                                 nullptr);
@@ -71,10 +100,16 @@ void App::CreateDescriptorSetLayout()
 }
 void App::CreatePipeline()
 {
+    mPipelineBuilder = vk::PipelineBuilder::New(mDevice, mJobSystem);
     // 创建模型渲染管线
     {
         vk::ShaderModule::Ptr ModelVertexModule = vk::ShaderModule::New(mDevice, VK_SHADER_STAGE_VERTEX_BIT, "./assets/shaders/model.vert.spv");
-        vk::ShaderModule::Ptr ModelFragmentModule = vk::ShaderModule::New(mDevice, VK_SHADER_STAGE_FRAGMENT_BIT, "./assets/shaders/model.frag.spv");
+        // 片段着色器按设备是否支持纹理数组非一致索引与片段着色器写入选择版本
+        mIsTextureArrayIndexing2 = mDevice->IsTextureArrayNonUniformIndexingSupported();
+        mIsTextureFeedback2 = mDevice->IsFragmentStoresAndAtomicsSupported();
+        std::string ModelFragmentPath = std::string("./assets/shaders/model.frag") + (mIsTextureArrayIndexing2 ? ".nonuniform" : "") + (mIsTextureFeedback2 ? ".feedback" : "") + ".spv";
+        vk::ShaderModule::Ptr ModelFragmentModule = vk::ShaderModule::New(mDevice, VK_SHADER_STAGE_FRAGMENT_BIT, ModelFragmentPath);
+        //
 
         VkVertexInputBindingDescription VertexInputBindingDescription{};
         VertexInputBindingDescription.binding = 0;
@@ -111,7 +146,7 @@ void App::CreatePipeline()
             ColorAttributeDescription,
             TexCoordAttributeDescription,
         };
-        mModelPipeline = vk::Pipeline::New(mDevice, mDescriptorSetLayout, ModelPipelineInfo);
+        mModelPipelineFuture = mPipelineBuilder->Build("Model", mDescriptorSetLayout, ModelPipelineInfo);
     }
     // 创建广告牌渲染管线
     {
@@ -135,9 +170,15 @@ void App::CreatePipeline()
         ModelPipelineInfo.VertexInputAttributeDescriptionList = {
             PositionAttributeDescription,
         };
-        mBillboardPipeline = vk::Pipeline::New(mDevice, mDescriptorSetLayout, ModelPipelineInfo);
+        ModelPipelineInfo.IsTranslucent = true;
+        mBillboardPipelineFuture = mPipelineBuilder->Build("Billboard", mDescriptorSetLayout, ModelPipelineInfo);
     }
 }
+void App::WaitPipeline()
+{
+    mModelPipeline = mModelPipelineFuture.get();
+    mBillboardPipeline = mBillboardPipelineFuture.get();
+}
 void App::CreateCamera()
 {
     // 创建相机
@@ -145,109 +186,137 @@ void App::CreateCamera()
 }
 void App::CreateModelBuffer()
 {
+    // 模型空间动态缓冲区，平面与人物模型各占一个对象
+    mModelSpaceBuffer = vk::ShaderBuffer::NewDynamic(mDevice, sizeof(ModelSpaceLayout), 2);
+    // 几何池
+    mGeometryPool = vk::GeometryPool::New(mDevice, sizeof(Vertex), 512 * 1024, 2 * 1024 * 1024);
+    mDescriptorSet1 = vk::DescriptorSet::New(mDevice, mDescriptorSetLayout);
+    // 纹理管理器，同一文件只解码一次
+    mTextureManager = vk::TextureManager::New(mDevice);
+    // 每个绘制的数据，平面为第一个，之后依次为人物模型的各网格
+    std::vector<DrawDataLayout> DrawDataList(mMaxTextureCount);
     // 加载平面模型
     {
-        Assimp::Importer AssimpImporter;
-        const aiScene *Scene = AssimpImporter.ReadFile("./assets/models/pingmian.obj",
-                                                       aiProcess_ValidateDataStructure |
-                                                           aiProcess_ImproveCacheLocality |
-                                                           aiProcess_RemoveRedundantMaterials |
-                                                           aiProcess_FindInvalidData);
-        if (Scene == nullptr || Scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE)
+        std::vector<vk::ModelBuffer::ModelInfo<Vertex>> modelInfoList;
+        if (!LoadModel("./assets/models/pingmian.obj", &modelInfoList))
         {
-            printf(AssimpImporter.GetErrorString());
-            printf("\n");
-            return;
+            throw std::runtime_error("Failed to load plane model!");
         }
-        std::vector<vk::ModelBuffer::ModelInfo<Vertex>> modelInfoList;
-        vk::ModelBuffer::ProcessNode<Vertex>(Scene, Scene->mRootNode, &modelInfoList, std::bind(&App::ProcessMesh, this, std::placeholders::_1));
-        // 创建模型缓冲区
-        uint64_t VertexDataSize = modelInfoList[0].Vertex.size() * sizeof(modelInfoList[0].Vertex[0]);
-        uint64_t IndexDataSize = modelInfoList[0].VertexIndex.size() * sizeof(modelInfoList[0].VertexIndex[0]);
-        mModelBuffer1 = vk::ModelBuffer::New(mDevice, modelInfoList[0].Vertex.data(), VertexDataSize,
-                                                 modelInfoList[0].VertexIndex.data(), IndexDataSize, modelInfoList[0].VertexIndex.size());
-        //
-        // 创建描述符
-        mDescriptorSet1 = vk::DescriptorSet::New(mDevice, mDescriptorSetLayout);
-        // 纹理
-        vk::Image::ImageInfo TextureInfo = vk::Image::OpenImageFile("./assets/images/pingmian.png");
-        mTextureBuffer1 = vk::ShaderImage::New(mDevice, TextureInfo.Width, TextureInfo.Height, false);
-        mTextureBuffer1->AllWriteData(TextureInfo.Data);
-        mTextureBuffer1->WriteDescriptorSet({mDescriptorSet1}, 0);
-        TextureInfo.Free();
+        // 写入几何池
+        if (!mGeometryPool->Allocate(modelInfoList[0].GetVertexData(), modelInfoList[0].GetVertexCount(),
+                                     modelInfoList[0].GetVertexIndexData(), modelInfoList[0].GetVertexIndexCount(), &mMesh1))
+        {
+            throw std::runtime_error("Geometry pool is full!");
+        }
+        // 纹理，未使用的纹理数组元素同样需要有效的描述符，全部先写入平面纹理
+        mTextureHandle1 = mTextureManager->Register("./assets/images/pingmian.png");
+        vk::ShaderImage::Ptr Texture = mTextureManager->Get(mTextureHandle1);
+        if (Texture == nullptr)
+        {
+            throw std::runtime_error("Failed to load plane texture!");
+        }
+        for (uint32_t i = 0; i < mMaxTextureCount; i++)
+        {
+            Texture->WriteDescriptorSet({mDescriptorSet1}, 0, i);
+        }
+        DrawDataList[0].TextureIndex = 0;
         // 变换矩阵
-        mModelSpaceBuffer1 = vk::ShaderBuffer::New(mDevice, sizeof(ModelSpaceLayout), true);
-        mModelSpaceBuffer1->WriteDescriptorSet({mDescriptorSet1}, 12);
         ModelSpaceLayout ModelSpace{};
         ModelSpace.ModelMat = glm::mat4(1.0f);
         ModelSpace.ModelMat = glm::scale(ModelSpace.ModelMat, glm::vec3(3.0f));
-        mModelSpaceBuffer1->AllWriteData(&ModelSpace);
+        mModelSpaceBuffer->AllWriteElementData(0, &ModelSpace);
     }
     // 加载人物模型
     {
-        Assimp::Importer AssimpImporter;
-        const aiScene *Scene = AssimpImporter.ReadFile("./assets/models/xiaoluoli/xiaoluoli.obj",
-                                                       aiProcess_ValidateDataStructure |
-                                                           aiProcess_ImproveCacheLocality |
-                                                           aiProcess_RemoveRedundantMaterials |
-                                                           aiProcess_FindInvalidData);
-        if (Scene == nullptr || Scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE)
+        std::vector<vk::ModelBuffer::ModelInfo<Vertex>> modelInfoList;
+        if (!LoadModel("./assets/models/xiaoluoli/xiaoluoli.obj", &modelInfoList))
         {
-            printf(AssimpImporter.GetErrorString());
-            printf("\n");
-            return;
+            throw std::runtime_error("Failed to load character model!");
         }
-        std::vector<vk::ModelBuffer::ModelInfo<Vertex>> modelInfoList;
-        vk::ModelBuffer::ProcessNode<Vertex>(Scene, Scene->mRootNode, &modelInfoList, std::bind(&App::ProcessMesh, this, std::placeholders::_1));
+        // 注册纹理，网格按名称查找，只解码被使用的文件，解码在解码线程上异步进行
         std::vector<std::string> TextureFileList{
             "./assets/models/xiaoluoli/shenti.jpg",
             "./assets/models/xiaoluoli/tou.jpg",
             "./assets/models/xiaoluoli/toufa.jpg",
             "./assets/models/xiaoluoli/yifu.jpg",
         };
-        mModelBufferList2.resize(modelInfoList.size());
-        mDescriptorSetList2.resize(modelInfoList.size());
-        mTextureBufferList2.resize(modelInfoList.size());
-        for (size_t i = 0; i < modelInfoList.size(); i++)
+        for (auto &&i : TextureFileList)
         {
-            // 创建模型缓冲区
-            uint64_t VertexDataSize = modelInfoList[i].Vertex.size() * sizeof(modelInfoList[i].Vertex[i]);
-            uint64_t IndexDataSize = modelInfoList[i].VertexIndex.size() * sizeof(modelInfoList[i].VertexIndex[i]);
-            mModelBufferList2[i] = vk::ModelBuffer::New(mDevice, modelInfoList[i].Vertex.data(), VertexDataSize,
-                                                            modelInfoList[i].VertexIndex.data(), IndexDataSize, modelInfoList[i].VertexIndex.size());
-            //
-            // 创建描述符
-            mDescriptorSetList2[i] = vk::DescriptorSet::New(mDevice, mDescriptorSetLayout);
-            // 创建纹理
-            bool IsHave = false;
-            for (size_t j = 0; j < TextureFileList.size(); j++)
+            mTextureManager->Register(i);
+        }
+        // 平面纹理占用纹理数组的第一个元素
+        if (modelInfoList.size() + 1 > mMaxTextureCount)
+        {
+            throw std::runtime_error("Too many textures for texture array!");
+        }
+        mMeshList2.resize(modelInfoList.size());
+        // 逐个绘制时每个网格的描述符，纹理数组的元素全部先写入平面纹理
+        if (!mIsTextureArrayIndexing2)
+        {
+            mDescriptorSetList2.resize(modelInfoList.size());
+            for (auto &&i : mDescriptorSetList2)
             {
-                vk::Image::ImageInfo TextureInfo = vk::Image::OpenImageFile(TextureFileList[j]);
-                if (TextureInfo.Name == modelInfoList[i].ModelName)
+                i = vk::DescriptorSet::New(mDevice, mDescriptorSetLayout);
+                for (uint32_t j = 0; j < mMaxTextureCount; j++)
                 {
-                    mTextureBufferList2[i] = vk::ShaderImage::New(mDevice, TextureInfo.Width, TextureInfo.Height, false);
-                    mTextureBufferList2[i]->AllWriteData(TextureInfo.Data);
-                    mTextureBufferList2[i]->WriteDescriptorSet({mDescriptorSetList2[i]}, 0);
-                    TextureInfo.Free();
-                    IsHave = true;
+                    mTextureManager->Get(mTextureHandle1)->WriteDescriptorSet({i}, 0, j);
                 }
             }
-            if (!IsHave)
+        }
+        mTextureHandleList2.resize(modelInfoList.size());
+        mBoundTextureList2.assign(mDevice->GetFrameInFlightCount(), std::vector<BoundTexture>(modelInfoList.size(), {mTextureHandle1, mTextureManager->GetVersion(mTextureHandle1), 0}));
+        std::vector<VkDrawIndexedIndirectCommand> IndirectCommandList(modelInfoList.size());
+        // 人物模型的模型矩阵为单位矩阵，导入时计算的模型空间包围球即世界空间的包围球
+        std::vector<glm::vec4> BoundingSphereList(modelInfoList.size());
+        for (size_t i = 0; i < modelInfoList.size(); i++)
+        {
+            // 写入几何池
+            if (!mGeometryPool->Allocate(modelInfoList[i].GetVertexData(), modelInfoList[i].GetVertexCount(),
+                                         modelInfoList[i].GetVertexIndexData(), modelInfoList[i].GetVertexIndexCount(), &mMeshList2[i]))
+            {
+                throw std::runtime_error("Geometry pool is full!");
+            }
+            // 间接绘制参数，firstInstance对应每个绘制的数据
+            uint32_t DrawIndex = i + 1;
+            IndirectCommandList[i].indexCount = mMeshList2[i].IndexCount;
+            IndirectCommandList[i].instanceCount = 1;
+            IndirectCommandList[i].firstIndex = mMeshList2[i].FirstIndex;
+            IndirectCommandList[i].vertexOffset = mMeshList2[i].VertexOffset;
+            IndirectCommandList[i].firstInstance = DrawIndex;
+            DrawDataList[DrawIndex].TextureIndex = DrawIndex;
+            BoundingSphereList[i] = modelInfoList[i].Bounds.Sphere;
+            // 纹理名称与网格名称相同，找不到或加载失败时使用平面纹理，该位置已写入平面纹理作为占位
+            mTextureHandleList2[i] = mTextureManager->Find(modelInfoList[i].ModelName);
+            if (mTextureHandleList2[i] == vk::TextureManager::mInvalidHandle)
             {
-                vk::Image::ImageInfo TextureInfo = vk::Image::OpenImageFile("./assets/images/pingmian.png");
-                mTextureBufferList2[i] = vk::ShaderImage::New(mDevice, TextureInfo.Width, TextureInfo.Height, false);
-                mTextureBufferList2[i]->AllWriteData(TextureInfo.Data);
-                mTextureBufferList2[i]->WriteDescriptorSet({mDescriptorSetList2[i]}, 0);
-                TextureInfo.Free();
+                mTextureHandleList2[i] = mTextureHandle1;
             }
+            mTextureManager->Request(mTextureHandleList2[i]);
+        }
+        // 剔除后的绘制参数通过间接绘制提交，firstInstance不为0需要设备支持，各绘制的纹理不同需要非一致索引
+        // 不支持间接绘制数量时剔除通道保留全部绘制，不可见的实例数为0，仍然一次间接绘制
+        if (mIsTextureArrayIndexing2 && mDevice->IsDrawIndirectFirstInstanceSupported())
+        {
+            mCullingPass2 = vk::CullingPass::New(mDevice, IndirectCommandList, BoundingSphereList);
+            // 剔除着色器加载失败时回退到CPU剔除，界面中显示当前使用的剔除方式
+            if (!mCullingPass2->IsValid())
+            {
+                mCullingPass2 = nullptr;
+            }
+        }
+        mFrustumCuller2 = vk::FrustumCuller::New();
+        for (auto &&i : BoundingSphereList)
+        {
+            mFrustumCuller2->Add(i);
         }
         // 变换矩阵
-        mModelSpaceBuffer2 = vk::ShaderBuffer::New(mDevice, sizeof(ModelSpaceLayout), true);
-        mModelSpaceBuffer2->WriteDescriptorSet(mDescriptorSetList2, 12);
         ModelSpaceLayout ModelSpace{};
         ModelSpace.ModelMat = glm::mat4(1.0f);
-        mModelSpaceBuffer2->AllWriteData(&ModelSpace);
+        mModelSpaceBuffer->AllWriteElementData(1, &ModelSpace);
     }
+    // 每个绘制的数据
+    mDrawDataBuffer = vk::ShaderBuffer::NewStorage(mDevice, DrawDataList.size() * sizeof(DrawDataLayout), false);
+    mDrawDataBuffer->AllWriteData(DrawDataList.data());
     // 加载广告牌模型
     {
         // 广告牌顶点数据
@@ -282,17 +351,10 @@ void App::CreateModelBuffer()
             mSpotLightList[i].Color = SpotLightColorList[i];
             mSpotLightList[i].Size = 1.0f;
         }
-        mDescriptorSetList3.resize(mSpotLightList.size());
-        mSpotLightBufferList3.resize(mSpotLightList.size());
-        for (size_t i = 0; i < mSpotLightList.size(); i++)
-        {
-            // 描述符
-            mDescriptorSetList3[i] = vk::DescriptorSet::New(mDevice, mDescriptorSetLayout);
-            // 着色器缓冲区
-            mSpotLightBufferList3[i] = vk::ShaderBuffer::New(mDevice, sizeof(SpotLightLayout), true);
-            mSpotLightBufferList3[i]->WriteDescriptorSet({mDescriptorSetList3[i]}, 13);
-            mSpotLightBufferList3[i]->AllWriteData(&mSpotLightList[i]);
-        }
+        // 所有点光存放在一个存储缓冲区中，一次实例化绘制全部广告牌
+        mDescriptorSet3 = vk::DescriptorSet::New(mDevice, mDescriptorSetLayout);
+        mSpotLightBuffer = vk::ShaderBuffer::NewStorage(mDevice, sizeof(SpotLightLayout) * mSpotLightList.size(), true);
+        mSpotLightBuffer->AllWriteData(mSpotLightList.data());
     }
 }
 void App::CreateShaderBuffer()
@@ -301,12 +363,32 @@ void App::CreateShaderBuffer()
     mCameraSpaceBuffer = vk::ShaderBuffer::New(mDevice, sizeof(CameraSpaceLayout), true);
     mIlluminationBuffer = vk::ShaderBuffer::New(mDevice, sizeof(IlluminationLayout), true);
 
-    mCameraSpaceBuffer->WriteDescriptorSet({mDescriptorSet1}, 10);
-    mCameraSpaceBuffer->WriteDescriptorSet(mDescriptorSetList2, 10);
-    mCameraSpaceBuffer->WriteDescriptorSet(mDescriptorSetList3, 10);
+    // 平面与人物模型的描述符
+    std::vector<vk::DescriptorSet::Ptr> ModelDescriptorSetList{mDescriptorSet1};
+    ModelDescriptorSetList.insert(ModelDescriptorSetList.end(), mDescriptorSetList2.begin(), mDescriptorSetList2.end());
+
+    mCameraSpaceBuffer->WriteDescriptorSet(ModelDescriptorSetList, 10);
+    mCameraSpaceBuffer->WriteDescriptorSet({mDescriptorSet3}, 10);
+    if (mCullingPass2 != nullptr)
+    {
+        mCameraSpaceBuffer->WriteDescriptorSet({mCullingPass2->GetDescriptorSet()}, 10);
+    }
+
+    mIlluminationBuffer->WriteDescriptorSet(ModelDescriptorSetList, 11);
+
+    // 动态描述符在绑定时需要全部提供偏移，因此每个描述符都写入
+    mModelSpaceBuffer->WriteDescriptorSet(ModelDescriptorSetList, 12);
+    mModelSpaceBuffer->WriteDescriptorSet({mDescriptorSet3}, 12);
+
+    mSpotLightBuffer->WriteDescriptorSet({mDescriptorSet3}, 13);
+
+    mDrawDataBuffer->WriteDescriptorSet(ModelDescriptorSetList, 14);
 
-    mIlluminationBuffer->WriteDescriptorSet({mDescriptorSet1}, 11);
-    mIlluminationBuffer->WriteDescriptorSet(mDescriptorSetList2, 11);
+    // 纹理流送反馈每帧一段，主机读取后重置为最大值
+    mTextureFeedbackBuffer = vk::ShaderBuffer::NewStorage(mDevice, sizeof(uint32_t) * mMaxTextureCount, true);
+    std::vector<uint32_t> TextureFeedbackList(mMaxTextureCount, UINT32_MAX);
+    mTextureFeedbackBuffer->AllWriteData(TextureFeedbackList.data());
+    mTextureFeedbackBuffer->WriteDescriptorSet(ModelDescriptorSetList, 15);
 }
 void App::WriteShaderBuffer()
 {
@@ -389,6 +471,11 @@ void App::ProcessEvent()
                 mIsWindowClose = true;
             }
             break;
+            case SDL_WINDOWEVENT_SIZE_CHANGED: // 窗口尺寸变化
+            {
+                mRenderer->SetSwapchainDirty();
+            }
+            break;
             }
         }
         break;
@@ -401,6 +488,41 @@ void App::ProcessEvent()
                 mIsWindowClose = true;
             }
             break;
+            case SDLK_F1: // 切换CPU与GPU帧重叠
+            {
+                mRenderer->SetFrameOverlap(!mRenderer->IsFrameOverlap());
+            }
+            break;
+            case SDLK_F2: // 切换多线程录制
+            {
+                mRenderer->SetParallelRecord(!mRenderer->IsParallelRecord());
+            }
+            break;
+            case SDLK_F3: // 切换视锥体剔除
+            {
+                mIsCullEnable2 = !mIsCullEnable2;
+                if (mCullingPass2 != nullptr)
+                {
+                    mCullingPass2->SetCullEnable(mIsCullEnable2);
+                }
+            }
+            break;
+            case SDLK_F4: // 测试CPU剔除的吞吐量
+            {
+                mCullBenchmark = vk::FrustumCuller::Benchmark(1000000);
+            }
+            break;
+            case SDLK_F5: // 测试网格转换耗时
+            {
+                BenchmarkImport("./assets/models/xiaoluoli/xiaoluoli.obj");
+            }
+            break;
+            case SDLK_F6: // 切换纹理流送的显存预算
+            {
+                uint64_t Budget = mTextureManager->GetStreamingBudget() * 2;
+                mTextureManager->SetStreamingBudget(Budget > 256ull * 1024 * 1024 ? 16ull * 1024 * 1024 : Budget);
+            }
+            break;
             }
         }
         break;
@@ -417,11 +539,71 @@ void App::GuiDesign()
     ImGui::Text(std::string("FrameRate: " + std::to_string(mFrameRate)).c_str());
     ImGui::Text(std::string("Yaw: " + std::to_string(CameraView.x) + "," + "Pitch: " + std::to_string(CameraView.y)).c_str());
     ImGui::Text(std::string("X: " + std::to_string(CameraPos.x) + ",Y: " + std::to_string(CameraPos.y) + ",Z: " + std::to_string(CameraPos.z)).c_str());
+    // 显存分配统计
+    vk::MemoryAllocator::Statistics MemoryStats = mDevice->GetMemoryAllocator()->GetStatistics();
+    ImGui::Text(std::string("MemoryBlock: " + std::to_string(MemoryStats.BlockCount) + ",Dedicated: " + std::to_string(MemoryStats.DedicatedBlockCount) +
+                            ",Allocation: " + std::to_string(MemoryStats.AllocationCount))
+                    .c_str());
+    ImGui::Text(std::string("MemoryUsed: " + std::to_string(MemoryStats.UsedBytes / 1024) + "KB/" + std::to_string(MemoryStats.BlockBytes / 1024) + "KB").c_str());
+    ImGui::Text(std::string("FreeRange: " + std::to_string(MemoryStats.FreeRangeCount) + ",Fragmentation: " + std::to_string(MemoryStats.Fragmentation)).c_str());
+    // 启动耗时与各管线编译耗时
+    ImGui::Text(std::string("Startup: " + std::to_string(mStartupTime) + "ms,Pipeline: " + std::to_string(mPipelineCreateTime) + "ms" +
+                            (mDevice->GetPipelineCacheLoadSize() > 0 ? "(warm)" : "(cold)"))
+                    .c_str());
+    for (auto &&i : mPipelineBuilder->GetBuildRecordList())
+    {
+        ImGui::Text(std::string("  " + i.Name + ": " + std::to_string(i.BuildTime) + "ms").c_str());
+    }
+    ImGui::Text(std::string("Texture: " + std::to_string(mTextureManager->GetDecodeCount()) + " decoded/" + std::to_string(mTextureManager->GetTextureCount()) + " registered,Pending: " +
+                            std::to_string(mTextureManager->GetPendingCount()))
+                    .c_str());
+    ImGui::Text(std::string("TextureDecode: " + std::to_string(mTextureManager->GetDecodeSpeed()) + "MB/s,Upload: " + std::to_string(mTextureManager->GetUploadSpeed()) + "MB/s").c_str());
+    ImGui::Text(std::string("TextureCompressed: " + std::to_string(mTextureManager->GetCompressedCount()) + ",Memory: " + std::to_string(mTextureManager->GetTextureMemory() / 1048576.0f) + "MB").c_str());
+    ImGui::Text(std::string("TextureStreaming(F6): " + std::to_string(mTextureManager->GetStreamingMemory() / 1048576.0f) + "/" + std::to_string(mTextureManager->GetStreamingBudget() / 1048576) +
+                            "MB,In: " + std::to_string(mTextureManager->GetStreamInCount()) + ",Out: " + std::to_string(mTextureManager->GetStreamOutCount()) +
+                            ",Streamed: " + std::to_string(mTextureManager->GetStreamInBytes() / 1048576.0f) + "MB")
+                    .c_str());
+    ImGui::Text(std::string("Mesh: " + std::to_string(mMeshLoadTime) + "ms,Cache: " + std::to_string(mMeshCacheHitCount) + "/" + std::to_string(mMeshLoadCount) +
+                            (mMeshCacheHitCount == mMeshLoadCount ? "(warm)" : "(cold)"))
+                    .c_str());
+    // 帧耗时
+    ImGui::Text(std::string("FrameOverlap(F1): " + std::string(mRenderer->IsFrameOverlap() ? "On" : "Off") +
+                            ",FenceWait: " + std::to_string(mRenderer->GetFenceWaitTime()) + "ms,Record: " + std::to_string(mRenderer->GetRecordTime()) + "ms")
+                    .c_str());
+    ImGui::Text(std::string("ParallelRecord(F2): " + std::string(mRenderer->IsParallelRecord() ? "On" : "Off") +
+                            ",Thread: " + std::to_string(mRenderer->GetRecordThreadUsed()) + "/" + std::to_string(mRenderer->GetRecordThreadCount()) +
+                            ",Draw: " + std::to_string(mRenderer->GetDrawCount()))
+                    .c_str());
+    ImGui::Text(std::string("Bind: " + std::to_string(mRenderer->GetBindIssuedCount()) + ",Skipped: " + std::to_string(mRenderer->GetBindSkippedCount())).c_str());
+    // 视锥体剔除
+    if (mCullingPass2 != nullptr)
+    {
+        ImGui::Text(std::string("Culling(F3): " + std::string(mIsCullEnable2 ? "On" : "Off") +
+                                ",Visible: " + std::to_string(mCullingPass2->GetVisibleCount()) + "/" + std::to_string(mCullingPass2->GetDrawCount()) + "(GPU)")
+                        .c_str());
+    }
+    else
+    {
+        ImGui::Text(std::string("Culling(F3): " + std::string(mIsCullEnable2 ? "On" : "Off") +
+                                ",Visible: " + std::to_string(mVisibleIndexList2.size()) + "/" + std::to_string(mFrustumCuller2->GetSphereCount()) +
+                                "(CPU " + vk::FrustumCuller::GetInstructionSet() + ")")
+                        .c_str());
+    }
+    ImGui::Text(std::string("CullBenchmark(F4): " + std::to_string(mCullBenchmark) + "M/s per core").c_str());
+    ImGui::Text(std::string("ConvertBenchmark(F5): " + std::to_string(mConvertMeshCount) + " meshes,Serial: " + std::to_string(mConvertSerialTime) +
+                            "ms,Parallel: " + std::to_string(mConvertParallelTime) + "ms")
+                    .c_str());
+    // 交换链
+    ImGui::Text(std::string("Swapchain: " + std::to_string(mDevice->GetSwapchainImageExtent().width) + "x" + std::to_string(mDevice->GetSwapchainImageExtent().height) +
+                            ",Recreate: " + std::to_string(mDevice->GetSwapchainRecreateCount()) + "(" + std::to_string(mDevice->GetSwapchainRecreateTime()) + "ms)")
+                    .c_str());
     ImGui::End();
 }
 void App::DrawOperations(uint32_t currentIndex)
 {
-    // 更新相机空间缓冲区
+    // 更新相机空间缓冲区，投影矩阵跟随交换链尺寸
+    mCamera->Resize(mDevice->GetSwapchainImageExtent());
+    mRenderer->SetSortDepthRange(mCamera->GetFarPoint());
     CameraSpaceLayout CameraSpace{};
     CameraSpace.ProjectionMat = mCamera->GetProjectionMat();
     CameraSpace.ViewMat = mCamera->GetViewMat();
@@ -432,81 +614,232 @@ void App::DrawOperations(uint32_t currentIndex)
     IlluminationLayout Illumination{};
     Illumination.AmbientLightIntensity = 0.001f;
     Illumination.AmbientLightColor = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
-    Illumination.SpotLightCount = mSpotLightList.size();
-    for (size_t i = 0; i < mSpotLightList.size(); i++)
+    // 光照计算最多使用前10个点光
+    Illumination.SpotLightCount = std::min<size_t>(mSpotLightList.size(), std::size(Illumination.SpotLightS));
+    for (int i = 0; i < Illumination.SpotLightCount; i++)
     {
         Illumination.SpotLightS[i] = mSpotLightList[i];
     }
     mIlluminationBuffer->WriteData(currentIndex, &Illumination);
 
-    // 绘制
-    mRenderer->Draw(mModelBuffer1, mDescriptorSet1, mModelPipeline);
-    for (size_t i = 0; i < mModelBufferList2.size(); i++)
+    // 本帧围栏已触发，读取上次使用该段的帧写入的纹理反馈，按当时绑定的图像换算为完整mip链的级别
+    if (mIsTextureFeedback2)
     {
-        mRenderer->Draw(mModelBufferList2[i], mDescriptorSetList2[i], mModelPipeline);
+        std::array<uint32_t, mMaxTextureCount> TextureFeedbackList{};
+        mTextureFeedbackBuffer->ReadData(currentIndex, TextureFeedbackList.data());
+        for (size_t i = 0; i < mTextureHandleList2.size(); i++)
+        {
+            const BoundTexture &Bound = mBoundTextureList2[currentIndex][i];
+            uint32_t Feedback = TextureFeedbackList[i + 1];
+            if (Feedback != UINT32_MAX && mTextureManager->IsStreamed(Bound.TextureHandle))
+            {
+                mTextureManager->ReportFeedback(Bound.TextureHandle, std::max<int32_t>(static_cast<int32_t>(Bound.BaseLevel + Feedback) - static_cast<int32_t>(mTextureFeedbackBias), 0));
+            }
+        }
+        TextureFeedbackList.fill(UINT32_MAX);
+        mTextureFeedbackBuffer->WriteData(currentIndex, TextureFeedbackList.data());
     }
-    for (size_t i = 0; i < mDescriptorSetList3.size(); i++)
+    else
     {
-        mRenderer->Draw(mModelBuffer3, mDescriptorSetList3[i], mBillboardPipeline);
+        // 没有反馈时人物模型的纹理按完整分辨率请求，仍受流送预算约束
+        for (auto &&i : mTextureHandleList2)
+        {
+            mTextureManager->ReportFeedback(i, 0);
+        }
     }
 
+    // 上传已解码的纹理并换入换出mip级别，图像就绪或替换后更新本帧描述符，其余帧的描述符可能仍在使用，轮到该帧时再替换
+    mTextureManager->Update();
+    for (size_t i = 0; i < mTextureHandleList2.size(); i++)
+    {
+        vk::TextureManager::Handle TextureHandle = mTextureHandleList2[i];
+        BoundTexture &Bound = mBoundTextureList2[currentIndex][i];
+        if ((Bound.TextureHandle != TextureHandle || Bound.Version != mTextureManager->GetVersion(TextureHandle)) && mTextureManager->IsReady(TextureHandle))
+        {
+            if (mIsTextureArrayIndexing2)
+            {
+                mTextureManager->Get(TextureHandle)->WriteDescriptorSet(currentIndex, {mDescriptorSet1}, 0, i + 1);
+            }
+            else
+            {
+                mTextureManager->Get(TextureHandle)->WriteDescriptorSet(currentIndex, {mDescriptorSetList2[i]}, 0, 0);
+            }
+            Bound = {TextureHandle, mTextureManager->GetVersion(TextureHandle), mTextureManager->GetResidentLevel(TextureHandle)};
+        }
+    }
+
+    // 绘制，动态偏移对应模型空间
+    mRenderer->DrawMesh(mGeometryPool, mMesh1, mDescriptorSet1, mModelPipeline, 0, {mModelSpaceBuffer->GetDynamicOffset(0)});
+    // 人物模型先在计算着色器中剔除，可见的网格一次间接绘制，设备不支持时在CPU上剔除，可见的网格逐个直接绘制
+    if (mCullingPass2 != nullptr)
+    {
+        mRenderer->Compute([this, currentIndex](VkCommandBuffer commandBuffer)
+                           { mCullingPass2->Record(commandBuffer, currentIndex); });
+        if (mCullingPass2->IsCompact())
+        {
+            mRenderer->DrawIndirectCount(mGeometryPool, mDescriptorSet1, mModelPipeline, mCullingPass2->GetDrawBuffer(currentIndex), mCullingPass2->GetDrawCountBuffer(currentIndex),
+                                         mCullingPass2->GetDrawCount(), {mModelSpaceBuffer->GetDynamicOffset(1)});
+            //
+        }
+        else
+        {
+            mRenderer->DrawIndirect(mGeometryPool, mDescriptorSet1, mModelPipeline, mCullingPass2->GetDrawBuffer(currentIndex), mCullingPass2->GetDrawCount(),
+                                    {mModelSpaceBuffer->GetDynamicOffset(1)});
+            //
+        }
+    }
+    else
+    {
+        if (mIsCullEnable2)
+        {
+            mFrustumCuller2->Cull(CameraSpace.ProjectionMat * CameraSpace.ViewMat, mVisibleIndexList2);
+        }
+        else
+        {
+            mVisibleIndexList2.resize(mMeshList2.size());
+            std::iota(mVisibleIndexList2.begin(), mVisibleIndexList2.end(), 0);
+        }
+        for (auto &&i : mVisibleIndexList2)
+        {
+            mRenderer->DrawMesh(mGeometryPool, mMeshList2[i], mIsTextureArrayIndexing2 ? mDescriptorSet1 : mDescriptorSetList2[i], mModelPipeline, i + 1,
+                                {mModelSpaceBuffer->GetDynamicOffset(1)});
+            //
+        }
+    }
+    // 全部点光广告牌一次实例化绘制
+    mRenderer->DrawInstanced(mModelBuffer3, mDescriptorSet3, mBillboardPipeline, mSpotLightList.size(), {mModelSpaceBuffer->GetDynamicOffset(0)});
+
     // ImGui绘制
     mRenderer->DrawGUI(mGui);
 
-    // 更新点光源缓冲区
-    for (size_t i = 0; i < mSpotLightBufferList3.size(); i++)
+    // 更新点光源缓冲区，存储缓冲区不是动态的，整体写入本帧的一段
+    for (size_t i = 0; i < mSpotLightList.size(); i++)
     {
         glm::mat4 RotateLight = glm::rotate(glm::mat4(1.0f), mFrameTime, {0.0f, 0.0f, 1.0f});
         mSpotLightList[i].Position = glm::vec3(RotateLight * glm::vec4(mSpotLightList[i].Position, 1.0f));
-        mSpotLightBufferList3[i]->WriteData(currentIndex, &mSpotLightList[i]);
     }
+    mSpotLightBuffer->WriteData(currentIndex, mSpotLightList.data());
 }
 
-vk::ModelBuffer::ModelInfo<App::Vertex> App::ProcessMesh(aiMesh *mesh)
+bool App::LoadModel(std::string filePath, std::vector<vk::ModelBuffer::ModelInfo<Vertex>> *modelInfoList)
+{
+    const uint32_t ImportFlags = aiProcess_ValidateDataStructure |
+                                 aiProcess_ImproveCacheLocality |
+                                 aiProcess_RemoveRedundantMaterials |
+                                 aiProcess_FindInvalidData;
+    //
+    std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+    mMeshLoadCount++;
+    // 缓存按源文件哈希与导入标志匹配
+    std::string CacheFilePath = vk::MeshCache::GetCachePath(filePath);
+    uint64_t SourceHash = vk::MeshCache::HashFile(filePath);
+    if (SourceHash != 0 && vk::MeshCache::Load<Vertex>(CacheFilePath, SourceHash, ImportFlags, modelInfoList))
+    {
+        mMeshCacheHitCount++;
+    }
+    else
+    {
+        Assimp::Importer AssimpImporter;
+        const aiScene *Scene = AssimpImporter.ReadFile(filePath.c_str(), ImportFlags);
+        if (Scene == nullptr || Scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE)
+        {
+            printf(AssimpImporter.GetErrorString());
+            printf("\n");
+            return false;
+        }
+        modelInfoList->clear();
+        vk::ModelBuffer::ProcessNodeParallel<Vertex>(Scene, Scene->mRootNode, modelInfoList, std::bind(&App::ProcessMesh, this, std::placeholders::_1, std::placeholders::_2), mJobSystem);
+        // 写入失败只影响下次启动
+        if (SourceHash != 0 && !vk::MeshCache::Save<Vertex>(CacheFilePath, SourceHash, ImportFlags, *modelInfoList))
+        {
+            printf("Failed to write mesh cache: %s\n", CacheFilePath.c_str());
+        }
+    }
+    mMeshLoadTime += std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::steady_clock::now() - StartTime).count();
+    return true;
+}
+vk::ModelBuffer::ModelInfo<App::Vertex> App::ProcessMesh(aiMesh *mesh, const glm::mat4 &transform)
 {
     vk::ModelBuffer::ModelInfo<Vertex> modelInfo{};
     modelInfo.ModelName = mesh->mName.C_Str();
-    for (size_t i = 0; i < mesh->mNumVertices; i++)
+    // 一次分配全部顶点，每个属性单独一遍连续转换
+    modelInfo.Vertex.resize(mesh->mNumVertices);
+    Vertex *VertexData = modelInfo.Vertex.data();
+    // 位置
+    if (mesh->HasPositions())
     {
-        Vertex vertex{};
-        // 位置
-        if (mesh->HasPositions())
+        for (size_t i = 0; i < mesh->mNumVertices; i++)
         {
-            vertex.Position.x = mesh->mVertices[i].x;
-            vertex.Position.y = mesh->mVertices[i].y;
-            vertex.Position.z = mesh->mVertices[i].z;
+            VertexData[i].Position = glm::vec3(transform * glm::vec4(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z, 1.0f));
         }
-        // 法线
-        if (mesh->HasNormals())
+    }
+    // 法线，使用逆转置矩阵，非均匀缩放时保持垂直
+    if (mesh->HasNormals())
+    {
+        glm::mat3 NormalMat = glm::transpose(glm::inverse(glm::mat3(transform)));
+        for (size_t i = 0; i < mesh->mNumVertices; i++)
         {
-            vertex.Normal.x = mesh->mNormals[i].x;
-            vertex.Normal.y = mesh->mNormals[i].y;
-            vertex.Normal.z = mesh->mNormals[i].z;
+            VertexData[i].Normal = glm::normalize(NormalMat * glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z));
         }
-        // 颜色
-        vertex.Color = glm::vec4(1.0f);
-        if (mesh->GetNumColorChannels() == 4)
+    }
+    // 颜色，只使用第一组顶点颜色
+    if (mesh->HasVertexColors(0))
+    {
+        const aiColor4D *ColorData = mesh->mColors[0];
+        for (size_t i = 0; i < mesh->mNumVertices; i++)
         {
-            vertex.Color.r = mesh->mColors[i]->r;
-            vertex.Color.g = mesh->mColors[i]->g;
-            vertex.Color.b = mesh->mColors[i]->b;
-            vertex.Color.a = mesh->mColors[i]->a;
+            VertexData[i].Color = glm::vec4(ColorData[i].r, ColorData[i].g, ColorData[i].b, ColorData[i].a);
         }
-        // UV
-        if (mesh->GetNumUVChannels() == 1)
+    }
+    else
+    {
+        for (size_t i = 0; i < mesh->mNumVertices; i++)
         {
-            vertex.UV.x = mesh->mTextureCoords[0][i].x;
-            vertex.UV.y = 1 - mesh->mTextureCoords[0][i].y;
+            VertexData[i].Color = glm::vec4(1.0f);
         }
-        modelInfo.Vertex.push_back(vertex);
     }
-    // 顶点索引
-    for (size_t i = 0; i < mesh->mNumFaces; i++)
+    // UV
+    if (mesh->GetNumUVChannels() == 1)
     {
-        for (size_t j = 0; j < mesh->mFaces[i].mNumIndices; j++)
+        const aiVector3D *UVData = mesh->mTextureCoords[0];
+        for (size_t i = 0; i < mesh->mNumVertices; i++)
         {
-            modelInfo.VertexIndex.push_back(mesh->mFaces[i].mIndices[j]);
+            VertexData[i].UV = glm::vec2(UVData[i].x, 1 - UVData[i].y);
         }
     }
+    // 顶点索引，先统计数量再一次分配
+    size_t IndexCount = 0;
+    for (size_t i = 0; i < mesh->mNumFaces; i++)
+    {
+        IndexCount += mesh->mFaces[i].mNumIndices;
+    }
+    modelInfo.VertexIndex.resize(IndexCount);
+    uint32_t *IndexData = modelInfo.VertexIndex.data();
+    for (size_t i = 0; i < mesh->mNumFaces; i++)
+    {
+        memcpy(IndexData, mesh->mFaces[i].mIndices, sizeof(uint32_t) * mesh->mFaces[i].mNumIndices);
+        IndexData += mesh->mFaces[i].mNumIndices;
+    }
     return modelInfo;
 }
+void App::BenchmarkImport(std::string filePath)
+{
+    Assimp::Importer AssimpImporter;
+    const aiScene *Scene = AssimpImporter.ReadFile(filePath.c_str(), aiProcess_ValidateDataStructure);
+    if (Scene == nullptr || Scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE)
+    {
+        printf(AssimpImporter.GetErrorString());
+        printf("\n");
+        return;
+    }
+    // 只测量导入后的网格转换，不包含Assimp解析
+    std::vector<vk::ModelBuffer::ModelInfo<Vertex>> SerialList;
+    std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+    vk::ModelBuffer::ProcessNode<Vertex>(Scene, Scene->mRootNode, &SerialList, std::bind(&App::ProcessMesh, this, std::placeholders::_1, std::placeholders::_2));
+    mConvertSerialTime = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::steady_clock::now() - StartTime).count();
+    std::vector<vk::ModelBuffer::ModelInfo<Vertex>> ParallelList;
+    StartTime = std::chrono::steady_clock::now();
+    vk::ModelBuffer::ProcessNodeParallel<Vertex>(Scene, Scene->mRootNode, &ParallelList, std::bind(&App::ProcessMesh, this, std::placeholders::_1, std::placeholders::_2), mJobSystem);
+    mConvertParallelTime = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::steady_clock::now() - StartTime).count();
+    mConvertMeshCount = ParallelList.size();
+}
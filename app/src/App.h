@@ -1,13 +1,20 @@
 #pragma once
 #include "vk/Window.h"
+#include "vk/JobSystem.h"
 #include "vk/Device.h"
 #include "vk/Renderer.h"
 #include "vk/Camera.h"
 #include "vk/Gui.h"
 #include "vk/DescriptorSetLayout.h"
 #include "vk/Pipeline.h"
+#include "vk/PipelineBuilder.h"
 #include "vk/DescriptorSet.h"
 #include "vk/ModelBuffer.h"
+#include "vk/GeometryPool.h"
+#include "vk/CullingPass.h"
+#include "vk/FrustumCuller.h"
+#include "vk/MeshCache.h"
+#include "vk/TextureManager.h"
 #include "vk/ShaderImage.h"
 #include "vk/ShaderBuffer.h"
 
@@ -46,6 +53,12 @@ public:
         alignas(4) float Size;
     };
 
+    // 每个绘制的数据，着色器通过gl_InstanceIndex读取
+    struct DrawDataLayout
+    {
+        alignas(4) uint32_t TextureIndex;
+    };
+
     struct IlluminationLayout
     {
         alignas(4) float AmbientLightIntensity;
@@ -59,6 +72,8 @@ public:
     ~App();
 
 private:
+    // 任务系统
+    vk::JobSystem::Ptr mJobSystem;
     // 窗口
     vk::Window::Ptr mWindow;
     // 设备
@@ -76,36 +91,84 @@ private:
     float mFrameTime = 0;
     float mFrameStartTime = 0;
 
+    // 启动耗时，单位毫秒
+    float mStartupTime = 0;
+    float mPipelineCreateTime = 0;
+    // 网格加载耗时，以及命中网格缓存的模型数量
+    float mMeshLoadTime = 0;
+    uint32_t mMeshLoadCount = 0;
+    uint32_t mMeshCacheHitCount = 0;
+    // 网格转换的串行与并行耗时
+    float mConvertSerialTime = 0;
+    float mConvertParallelTime = 0;
+    uint32_t mConvertMeshCount = 0;
+
     // 描述符布局
     vk::DescriptorSetLayout::Ptr mDescriptorSetLayout;
+    // 纹理数组容量
+    static constexpr uint32_t mMaxTextureCount = 16;
 
     // 渲染管线
+    vk::PipelineBuilder::Ptr mPipelineBuilder;
+    std::future<vk::Pipeline::Ptr> mModelPipelineFuture;
+    std::future<vk::Pipeline::Ptr> mBillboardPipelineFuture;
     vk::Pipeline::Ptr mModelPipeline;
     vk::Pipeline::Ptr mBillboardPipeline;
 
     // 相机
     vk::Camera::Ptr mCamera;
 
-    // 平面模型
-    vk::ModelBuffer::Ptr mModelBuffer1;
+    // 几何池，平面与人物模型共用顶点与索引缓冲区
+    vk::GeometryPool::Ptr mGeometryPool;
+    // 纹理管理器，模型通过句柄共享纹理
+    vk::TextureManager::Ptr mTextureManager;
+    // 平面与人物模型共用描述符，纹理通过每个绘制的数据在纹理数组中选择
     vk::DescriptorSet::Ptr mDescriptorSet1;
-    vk::ShaderImage::Ptr mTextureBuffer1;
-    vk::ShaderBuffer::Ptr mModelSpaceBuffer1;
+    vk::ShaderBuffer::Ptr mDrawDataBuffer;
+    // 纹理流送反馈，片段着色器按纹理数组元素记录需要的最精细级别，加上偏移后写入，以便表示比当前图像第0级更精细的级别
+    vk::ShaderBuffer::Ptr mTextureFeedbackBuffer;
+    // 设备不支持片段着色器写入时不使用反馈
+    bool mIsTextureFeedback2 = false;
+    static constexpr uint32_t mTextureFeedbackBias = 16;
+
+    // 平面模型
+    vk::GeometryPool::Mesh mMesh1;
+    vk::TextureManager::Handle mTextureHandle1 = vk::TextureManager::mInvalidHandle;
 
     // 人物模型
-    std::vector<vk::ModelBuffer::Ptr> mModelBufferList2;
+    // 设备支持纹理数组非一致索引时与平面共用描述符，否则每个网格逐个绘制并绑定各自的描述符，纹理写入第一个元素
+    bool mIsTextureArrayIndexing2 = false;
     std::vector<vk::DescriptorSet::Ptr> mDescriptorSetList2;
-    std::vector<vk::ShaderImage::Ptr> mTextureBufferList2;
-    vk::ShaderBuffer::Ptr mModelSpaceBuffer2;
+    std::vector<vk::GeometryPool::Mesh> mMeshList2;
+    std::vector<vk::TextureManager::Handle> mTextureHandleList2;
+    // 每帧描述符中实际写入的纹理，异步加载完成前为平面纹理，流送纹理的图像替换后版本号改变
+    struct BoundTexture
+    {
+        vk::TextureManager::Handle TextureHandle;
+        uint32_t Version;
+        // 图像第0级对应的完整mip链级别，用于换算着色器反馈的级别
+        uint32_t BaseLevel;
+    };
+    std::vector<std::vector<BoundTexture>> mBoundTextureList2;
+    // 人物模型的视锥体剔除，支持间接绘制数量时在GPU上剔除，剔除后的全部网格一次间接绘制，否则在CPU上剔除
+    vk::CullingPass::Ptr mCullingPass2;
+    vk::FrustumCuller::Ptr mFrustumCuller2;
+    std::vector<uint32_t> mVisibleIndexList2;
+    bool mIsCullEnable2 = true;
+    // CPU剔除的吞吐量(百万/秒)
+    float mCullBenchmark = 0.0f;
 
     // 点光模型
     vk::ModelBuffer::Ptr mModelBuffer3;
-    std::vector<vk::DescriptorSet::Ptr> mDescriptorSetList3;
-    std::vector<vk::ShaderBuffer::Ptr> mSpotLightBufferList3;
+    vk::DescriptorSet::Ptr mDescriptorSet3;
 
     // 着色器缓冲区
     vk::ShaderBuffer::Ptr mCameraSpaceBuffer;
     vk::ShaderBuffer::Ptr mIlluminationBuffer;
+    // 动态着色器缓冲区
+    vk::ShaderBuffer::Ptr mModelSpaceBuffer;
+    // 存储缓冲区
+    vk::ShaderBuffer::Ptr mSpotLightBuffer;
 
     // 光数据
     std::vector<SpotLightLayout> mSpotLightList;
@@ -114,6 +177,7 @@ private:
     void Init();
     void CreateDescriptorSetLayout();
     void CreatePipeline();
+    void WaitPipeline();
     void CreateCamera();
     void CreateModelBuffer();
     void CreateShaderBuffer();
@@ -125,8 +189,12 @@ private:
     void DrawOperations(uint32_t currentIndex);
     void CalculateFrameRate();
 
-    // 处理顶点回调函数
-    vk::ModelBuffer::ModelInfo<Vertex> ProcessMesh(aiMesh *mesh);
+    // 优先从网格缓存加载模型，缓存失效时通过Assimp导入并写入缓存
+    bool LoadModel(std::string filePath, std::vector<vk::ModelBuffer::ModelInfo<Vertex>> *modelInfoList);
+    // 处理顶点回调函数，会在多个线程上同时调用
+    vk::ModelBuffer::ModelInfo<Vertex> ProcessMesh(aiMesh *mesh, const glm::mat4 &transform);
+    // 比较同一模型串行与并行转换网格的耗时
+    void BenchmarkImport(std::string filePath);
 
 public:
     void run();
@@ -13,10 +13,7 @@ namespace vk
         {
             vkDestroyBuffer(mDevice->GetLogicalDevice(), mBuffer, nullptr);
         }
-        if (mMemory != nullptr)
-        {
-            vkFreeMemory(mDevice->GetLogicalDevice(), mMemory, nullptr);
-        }
+        mDevice->FreeMemory(&mMemory);
     }
 
     void Buffer::CreateBuffer(VkBufferUsageFlags usage, VkMemoryPropertyFlags properties)
@@ -32,26 +29,40 @@ namespace vk
     }
     bool Buffer::WriteHostData(void *data)
     {
-        void *TempData;
-        if (vkMapMemory(mDevice->GetLogicalDevice(), mMemory, 0, mBufferSize, 0, &TempData) != VK_SUCCESS)
+        // 主机可见内存由分配器常驻映射，直接拷贝
+        if (mMemory.MappedData == nullptr)
         {
             return false;
         }
-        memcpy(TempData, data, mBufferSize);
-        vkUnmapMemory(mDevice->GetLogicalDevice(), mMemory);
+        memcpy(mMemory.MappedData, data, mBufferSize);
         return true;
     }
     bool Buffer::WriteData(void *data)
     {
-        Buffer::Ptr TempBuffer = Buffer::New(mDevice, mBufferSize,
-                                                 VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                                                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-        //
-        if (!TempBuffer->WriteHostData(data))
+        // 数据拷贝到上传器的暂存内存，传输命令记录到当前批次的传输队列
+        Uploader::StagingRange StagingRange{};
+        if (!mDevice->GetUploader()->WriteStaging(data, mBufferSize, &StagingRange))
+        {
+            return false;
+        }
+        if (!mDevice->UploadBuffer(StagingRange.Buffer, StagingRange.Offset, mBuffer, mBufferSize))
+        {
+            return false;
+        }
+        return true;
+    }
+    bool Buffer::WriteData(void *data, VkDeviceSize offset, VkDeviceSize size)
+    {
+        if (offset + size > mBufferSize)
+        {
+            return false;
+        }
+        Uploader::StagingRange StagingRange{};
+        if (!mDevice->GetUploader()->WriteStaging(data, size, &StagingRange))
         {
             return false;
         }
-        if (!WriteBuffer(TempBuffer))
+        if (!mDevice->UploadBuffer(StagingRange.Buffer, StagingRange.Offset, mBuffer, size, offset))
         {
             return false;
         }
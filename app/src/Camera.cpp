@@ -21,8 +21,29 @@ namespace vk
         Front.y = cos(glm::radians(mPitch)) * cos(glm::radians(mYaw));
         Front.z = sin(glm::radians(mPitch));
         mCameraFront = glm::normalize(Front);
-        VkExtent2D Extent = device->GetSwapchainImageExtent();
-        mProjectionMat = glm::perspective(glm::radians(focalLength), Extent.width / (float)Extent.height, proximalPoint, farPoint);
+        mFocalLength = focalLength;
+        mProximalPoint = proximalPoint;
+        mFarPoint = farPoint;
+        mExtent = device->GetSwapchainImageExtent();
+        UpdateProjectionMat();
+    }
+    void Camera::Resize(VkExtent2D extent)
+    {
+        if (extent.width == mExtent.width && extent.height == mExtent.height)
+        {
+            return;
+        }
+        mExtent = extent;
+        UpdateProjectionMat();
+    }
+    void Camera::UpdateProjectionMat()
+    {
+        // 最小化时尺寸为0，保留原有投影
+        if (mExtent.width == 0 || mExtent.height == 0)
+        {
+            return;
+        }
+        mProjectionMat = glm::perspective(glm::radians(mFocalLength), mExtent.width / (float)mExtent.height, mProximalPoint, mFarPoint);
         mProjectionMat[1][1] *= -1;
     }
     void Camera::InputTick()
@@ -0,0 +1,37 @@
+#include "vk/ComputePipeline.h"
+
+namespace vk
+{
+    ComputePipeline::ComputePipeline(Device::Ptr device, DescriptorSetLayout::Ptr descriptorSet, ShaderModule::Ptr shaderModule)
+        : mDevice(device)
+    {
+        CreatePipeline(descriptorSet, shaderModule);
+    }
+    ComputePipeline::~ComputePipeline()
+    {
+        if (mPipeline != nullptr)
+        {
+            vkDestroyPipeline(mDevice->GetLogicalDevice(), mPipeline, nullptr);
+        }
+    }
+
+    void ComputePipeline::CreatePipeline(DescriptorSetLayout::Ptr descriptorSet, ShaderModule::Ptr shaderModule)
+    {
+        // 着色器
+        VkPipelineShaderStageCreateInfo ShaderStageCreateInfo{};
+        ShaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        ShaderStageCreateInfo.pName = "main";
+        ShaderStageCreateInfo.module = shaderModule->GetShaderModule();
+        ShaderStageCreateInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+
+        // 计算管线创建信息
+        VkComputePipelineCreateInfo ComputePipelineCreateInfo{};
+        ComputePipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        ComputePipelineCreateInfo.layout = descriptorSet->GetPipelineLayout();
+        ComputePipelineCreateInfo.stage = ShaderStageCreateInfo;
+        if (vkCreateComputePipelines(mDevice->GetLogicalDevice(), mDevice->GetPipelineCache(), 1, &ComputePipelineCreateInfo, nullptr, &mPipeline) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to create compute pipeline!");
+        }
+    }
+} // namespace vk
@@ -0,0 +1,17 @@
+#include "vk/ContentHash.h"
+
+namespace vk
+{
+    uint64_t ContentHash::Hash(const uint8_t *data, size_t size)
+    {
+        uint64_t Hash = 14695981039346656037ull;
+        for (size_t i = 0; i < size; i++)
+        {
+            Hash ^= data[i];
+            Hash *= 1099511628211ull;
+        }
+        Hash ^= size;
+        Hash *= 1099511628211ull;
+        return Hash == 0 ? 1 : Hash;
+    }
+} // namespace vk
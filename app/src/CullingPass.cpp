@@ -0,0 +1,173 @@
+#include "vk/CullingPass.h"
+
+namespace vk
+{
+    CullingPass::CullingPass(Device::Ptr device, std::vector<VkDrawIndexedIndirectCommand> drawCommandList, std::vector<glm::vec4> boundingSphereList)
+        : mDevice(device), mDrawCount(drawCommandList.size())
+    {
+        if (drawCommandList.empty() || drawCommandList.size() != boundingSphereList.size())
+        {
+            throw std::runtime_error("Invalid culling pass input!");
+        }
+        mIsCompact = mDevice->IsDrawIndirectCountSupported();
+        CreateDescriptorSet();
+        if (!CreatePipeline())
+        {
+            return;
+        }
+        CreateBuffer(drawCommandList, boundingSphereList);
+        WriteDescriptorSet();
+    }
+    CullingPass::~CullingPass()
+    {
+    }
+
+    void CullingPass::CreateDescriptorSet()
+    {
+        std::vector<VkDescriptorSetLayoutBinding> DescriptorSetLayoutBindingList;
+        // 相机空间缓冲区描述
+        VkDescriptorSetLayoutBinding CameraSpaceDescriptorSetLayoutBinding{};
+        CameraSpaceDescriptorSetLayoutBinding.binding = 10;
+        CameraSpaceDescriptorSetLayoutBinding.descriptorCount = 1;
+        CameraSpaceDescriptorSetLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        CameraSpaceDescriptorSetLayoutBinding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        DescriptorSetLayoutBindingList.push_back(CameraSpaceDescriptorSetLayoutBinding);
+        // 输入绘制参数、包围球、输出绘制参数与可见数量
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            VkDescriptorSetLayoutBinding StorageDescriptorSetLayoutBinding{};
+            StorageDescriptorSetLayoutBinding.binding = i;
+            StorageDescriptorSetLayoutBinding.descriptorCount = 1;
+            StorageDescriptorSetLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            StorageDescriptorSetLayoutBinding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+            DescriptorSetLayoutBindingList.push_back(StorageDescriptorSetLayoutBinding);
+        }
+        VkPushConstantRange PushConstantRange{};
+        PushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        PushConstantRange.offset = 0;
+        PushConstantRange.size = sizeof(CullLayout);
+        mDescriptorSetLayout = DescriptorSetLayout::New(mDevice, 1, DescriptorSetLayoutBindingList, &PushConstantRange);
+        mDescriptorSet = DescriptorSet::New(mDevice, mDescriptorSetLayout);
+    }
+    bool CullingPass::CreatePipeline()
+    {
+        ShaderModule::Ptr CullModule = ShaderModule::New(mDevice, VK_SHADER_STAGE_COMPUTE_BIT, "./assets/shaders/cull.comp.spv");
+        if (!CullModule->IsValid())
+        {
+            return false;
+        }
+        mPipeline = ComputePipeline::New(mDevice, mDescriptorSetLayout, CullModule);
+        return true;
+    }
+    void CullingPass::CreateBuffer(const std::vector<VkDrawIndexedIndirectCommand> &drawCommandList, const std::vector<glm::vec4> &boundingSphereList)
+    {
+        // 输入数据不再改变，写入设备本地内存
+        mInputDrawBuffer = Buffer::New(mDevice, drawCommandList.size() * sizeof(VkDrawIndexedIndirectCommand),
+                                       VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                       VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        //
+        mInputDrawBuffer->WriteData(const_cast<VkDrawIndexedIndirectCommand *>(drawCommandList.data()));
+        mBoundingSphereBuffer = Buffer::New(mDevice, boundingSphereList.size() * sizeof(glm::vec4),
+                                            VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        //
+        mBoundingSphereBuffer->WriteData(const_cast<glm::vec4 *>(boundingSphereList.data()));
+        // 可见数量使用主机可见内存，帧围栏触发后直接读取统计
+        for (uint32_t i = 0; i < mDevice->GetFrameInFlightCount(); i++)
+        {
+            mOutputDrawBufferList.push_back(Buffer::New(mDevice, drawCommandList.size() * sizeof(VkDrawIndexedIndirectCommand),
+                                                        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                                                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+            //
+            mDrawCountBufferList.push_back(Buffer::New(mDevice, sizeof(uint32_t),
+                                                       VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                                                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT));
+            //
+            if (mDrawCountBufferList[i]->GetMappedData() == nullptr)
+            {
+                throw std::runtime_error("Failed to map draw count buffer!");
+            }
+            memset(mDrawCountBufferList[i]->GetMappedData(), 0, sizeof(uint32_t));
+        }
+    }
+    void CullingPass::WriteDescriptorSet()
+    {
+        for (uint32_t i = 0; i < mDevice->GetFrameInFlightCount(); i++)
+        {
+            std::array<VkDescriptorBufferInfo, 4> DescriptorBufferInfoList{};
+            DescriptorBufferInfoList[0].buffer = mInputDrawBuffer->GetBuffer();
+            DescriptorBufferInfoList[1].buffer = mBoundingSphereBuffer->GetBuffer();
+            DescriptorBufferInfoList[2].buffer = mOutputDrawBufferList[i]->GetBuffer();
+            DescriptorBufferInfoList[3].buffer = mDrawCountBufferList[i]->GetBuffer();
+            std::array<VkWriteDescriptorSet, 4> WriteDescriptorSetList{};
+            for (uint32_t j = 0; j < WriteDescriptorSetList.size(); j++)
+            {
+                DescriptorBufferInfoList[j].offset = 0;
+                DescriptorBufferInfoList[j].range = VK_WHOLE_SIZE;
+
+                WriteDescriptorSetList[j].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                WriteDescriptorSetList[j].dstSet = mDescriptorSet->GetDescriptorSet(i);
+                WriteDescriptorSetList[j].dstBinding = j;
+                WriteDescriptorSetList[j].dstArrayElement = 0;
+                WriteDescriptorSetList[j].descriptorCount = 1;
+                WriteDescriptorSetList[j].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                WriteDescriptorSetList[j].pBufferInfo = &DescriptorBufferInfoList[j];
+            }
+            vkUpdateDescriptorSets(mDevice->GetLogicalDevice(), WriteDescriptorSetList.size(), WriteDescriptorSetList.data(), 0, nullptr);
+        }
+    }
+
+    void CullingPass::Record(VkCommandBuffer commandBuffer, uint32_t currentIndex)
+    {
+        // 帧围栏已经触发，读取上一次使用本帧资源时的可见数量
+        mVisibleCount = *static_cast<uint32_t *>(mDrawCountBufferList[currentIndex]->GetMappedData());
+
+        // 清零可见数量
+        vkCmdFillBuffer(commandBuffer, mDrawCountBufferList[currentIndex]->GetBuffer(), 0, sizeof(uint32_t), 0);
+        VkBufferMemoryBarrier BufferMemoryBarrier{};
+        BufferMemoryBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        BufferMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        BufferMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        BufferMemoryBarrier.buffer = mDrawCountBufferList[currentIndex]->GetBuffer();
+        BufferMemoryBarrier.offset = 0;
+        BufferMemoryBarrier.size = VK_WHOLE_SIZE;
+        BufferMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        BufferMemoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(commandBuffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+                             0, nullptr,
+                             1, &BufferMemoryBarrier,
+                             0, nullptr);
+        //
+
+        // 每个线程测试一个绘制
+        CullLayout Cull{};
+        Cull.DrawCount = mDrawCount;
+        Cull.IsCompact = mIsCompact;
+        Cull.IsCullEnable = mIsCullEnable;
+        VkDescriptorSet DescriptorSet = mDescriptorSet->GetDescriptorSet(currentIndex);
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mPipeline->GetPipeline());
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mDescriptorSetLayout->GetPipelineLayout(), 0, 1, &DescriptorSet, 0, nullptr);
+        vkCmdPushConstants(commandBuffer, mDescriptorSetLayout->GetPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullLayout), &Cull);
+        vkCmdDispatch(commandBuffer, (mDrawCount + 63) / 64, 1, 1);
+
+        // 剔除结果在间接绘制读取参数前可见
+        std::array<VkBufferMemoryBarrier, 2> ResultBarrierList{};
+        for (auto &&i : ResultBarrierList)
+        {
+            i = BufferMemoryBarrier;
+            i.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            i.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+        }
+        ResultBarrierList[0].buffer = mOutputDrawBufferList[currentIndex]->GetBuffer();
+        ResultBarrierList[1].buffer = mDrawCountBufferList[currentIndex]->GetBuffer();
+        // 可见数量在帧围栏触发后由主机读取
+        ResultBarrierList[1].dstAccessMask |= VK_ACCESS_HOST_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_HOST_BIT, 0,
+                             0, nullptr,
+                             ResultBarrierList.size(), ResultBarrierList.data(),
+                             0, nullptr);
+        //
+    }
+} // namespace vk
@@ -0,0 +1,159 @@
+#include "vk/DdsFile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace vk
+{
+    bool DdsFile::Save(std::string filePath, const TextureCompressor::CompressedImage &image, uint64_t sourceHash)
+    {
+        if (image.MipLevelList.empty() || image.Data.empty())
+        {
+            return false;
+        }
+        Header FileHeader{};
+        FileHeader.Size = sizeof(Header);
+        // CAPS|HEIGHT|WIDTH|PIXELFORMAT|MIPMAPCOUNT，压缩格式为LINEARSIZE，否则为PITCH
+        bool IsCompressed = image.ImageFormat != TextureCompressor::Format::RGBA8;
+        FileHeader.Flags = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | (IsCompressed ? 0x80000 : 0x8);
+        FileHeader.Height = image.Height;
+        FileHeader.Width = image.Width;
+        FileHeader.PitchOrLinearSize = IsCompressed ? image.MipLevelList[0].Size : image.Width * 4;
+        FileHeader.MipMapCount = image.MipLevelList.size();
+        FileHeader.Reserved1[0] = mSourceHashTag;
+        FileHeader.Reserved1[1] = static_cast<uint32_t>(sourceHash);
+        FileHeader.Reserved1[2] = static_cast<uint32_t>(sourceHash >> 32);
+        FileHeader.Format.Size = sizeof(PixelFormat);
+        FileHeader.Format.Flags = 0x4; // FOURCC
+        FileHeader.Format.FourCC = mFourCCDX10;
+        // TEXTURE|COMPLEX|MIPMAP
+        FileHeader.Caps = 0x1000 | (image.MipLevelList.size() > 1 ? 0x8 | 0x400000 : 0);
+        HeaderDX10 FileHeaderDX10{};
+        switch (image.ImageFormat)
+        {
+        case TextureCompressor::Format::BC1:
+            FileHeaderDX10.DxgiFormat = mDxgiFormatBC1Srgb;
+            break;
+        case TextureCompressor::Format::BC3:
+            FileHeaderDX10.DxgiFormat = mDxgiFormatBC3Srgb;
+            break;
+        case TextureCompressor::Format::RGBA8:
+            FileHeaderDX10.DxgiFormat = mDxgiFormatRGBA8Srgb;
+            break;
+        }
+        FileHeaderDX10.ResourceDimension = 3; // TEXTURE2D
+        FileHeaderDX10.ArraySize = 1;
+
+        std::string TempFilePath = filePath + ".tmp";
+        {
+            std::ofstream File(TempFilePath, std::ios::binary | std::ios::trunc);
+            if (!File.is_open())
+            {
+                return false;
+            }
+            File.write(reinterpret_cast<const char *>(&mMagic), sizeof(mMagic));
+            File.write(reinterpret_cast<const char *>(&FileHeader), sizeof(Header));
+            File.write(reinterpret_cast<const char *>(&FileHeaderDX10), sizeof(HeaderDX10));
+            File.write(reinterpret_cast<const char *>(image.Data.data()), image.Data.size());
+            if (!File.good())
+            {
+                return false;
+            }
+        }
+        // 部分平台上目标存在时无法替换，先删除旧文件
+        std::remove(filePath.c_str());
+        return std::rename(TempFilePath.c_str(), filePath.c_str()) == 0;
+    }
+    bool DdsFile::Parse(const uint8_t *data, size_t size, TextureCompressor::CompressedImage *image, const uint8_t **levelData, uint64_t *sourceHash)
+    {
+        if (data == nullptr || size < sizeof(uint32_t) + sizeof(Header))
+        {
+            return false;
+        }
+        uint32_t Magic = 0;
+        memcpy(&Magic, data, sizeof(Magic));
+        Header FileHeader{};
+        memcpy(&FileHeader, data + sizeof(Magic), sizeof(Header));
+        if (Magic != mMagic || FileHeader.Size != sizeof(Header) || FileHeader.Format.Size != sizeof(PixelFormat) || !(FileHeader.Format.Flags & 0x4))
+        {
+            return false;
+        }
+        // 确定块压缩格式，不支持的格式返回false
+        size_t DataOffset = sizeof(Magic) + sizeof(Header);
+        if (FileHeader.Format.FourCC == mFourCCDXT1)
+        {
+            image->ImageFormat = TextureCompressor::Format::BC1;
+        }
+        else if (FileHeader.Format.FourCC == mFourCCDXT5)
+        {
+            image->ImageFormat = TextureCompressor::Format::BC3;
+        }
+        else if (FileHeader.Format.FourCC == mFourCCDX10)
+        {
+            if (size < DataOffset + sizeof(HeaderDX10))
+            {
+                return false;
+            }
+            HeaderDX10 FileHeaderDX10{};
+            memcpy(&FileHeaderDX10, data + DataOffset, sizeof(HeaderDX10));
+            DataOffset += sizeof(HeaderDX10);
+            if (FileHeaderDX10.ResourceDimension != 3 || FileHeaderDX10.ArraySize > 1)
+            {
+                return false;
+            }
+            if (FileHeaderDX10.DxgiFormat == mDxgiFormatBC1 || FileHeaderDX10.DxgiFormat == mDxgiFormatBC1Srgb)
+            {
+                image->ImageFormat = TextureCompressor::Format::BC1;
+            }
+            else if (FileHeaderDX10.DxgiFormat == mDxgiFormatBC3 || FileHeaderDX10.DxgiFormat == mDxgiFormatBC3Srgb)
+            {
+                image->ImageFormat = TextureCompressor::Format::BC3;
+            }
+            else if (FileHeaderDX10.DxgiFormat == mDxgiFormatRGBA8 || FileHeaderDX10.DxgiFormat == mDxgiFormatRGBA8Srgb)
+            {
+                image->ImageFormat = TextureCompressor::Format::RGBA8;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        else
+        {
+            return false;
+        }
+        if (FileHeader.Width == 0 || FileHeader.Height == 0)
+        {
+            return false;
+        }
+        // 计算每个级别的偏移并检查文件长度
+        image->Width = FileHeader.Width;
+        image->Height = FileHeader.Height;
+        image->Data.clear();
+        image->MipLevelList.clear();
+        uint32_t LevelCount = std::max(1u, std::min(FileHeader.MipMapCount, TextureCompressor::GetMipLevelCount(FileHeader.Width, FileHeader.Height)));
+        uint64_t Offset = 0;
+        for (uint32_t i = 0; i < LevelCount; i++)
+        {
+            TextureCompressor::MipLevel Level{};
+            Level.Width = std::max(1u, FileHeader.Width >> i);
+            Level.Height = std::max(1u, FileHeader.Height >> i);
+            Level.Offset = Offset;
+            Level.Size = TextureCompressor::GetLevelSize(image->ImageFormat, Level.Width, Level.Height);
+            image->MipLevelList.push_back(Level);
+            Offset += Level.Size;
+        }
+        if (size - DataOffset < Offset)
+        {
+            return false;
+        }
+        *levelData = data + DataOffset;
+        if (sourceHash != nullptr)
+        {
+            *sourceHash = FileHeader.Reserved1[0] == mSourceHashTag ? (static_cast<uint64_t>(FileHeader.Reserved1[2]) << 32 | FileHeader.Reserved1[1]) : 0;
+        }
+        return true;
+    }
+} // namespace vk
@@ -13,8 +13,8 @@ namespace vk
 
     void DescriptorSet::CreateDescriptorSet()
     {
-        mDescriptorSet.resize(mDevice->GetSwapchainImageCount());
-        std::vector<VkDescriptorSetLayout> DescriptorSetLayoutList(mDevice->GetSwapchainImageCount(), mDescriptorSetLayout->GetDescriptorSetLayout());
+        mDescriptorSet.resize(mDevice->GetFrameInFlightCount());
+        std::vector<VkDescriptorSetLayout> DescriptorSetLayoutList(mDevice->GetFrameInFlightCount(), mDescriptorSetLayout->GetDescriptorSetLayout());
         VkDescriptorSetAllocateInfo DescriptorSetAllocateInfo{};
         DescriptorSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
         DescriptorSetAllocateInfo.descriptorPool = mDescriptorSetLayout->GetDescriptorPool();
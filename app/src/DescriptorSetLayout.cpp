@@ -31,6 +31,23 @@ namespace vk
 
     void DescriptorSetLayout::CreateDescriptorSetLayout(std::vector<VkDescriptorSetLayoutBinding> descriptorSetLayoutBindingList)
     {
+        // 检查动态统一缓冲区数量是否超出设备限制
+        uint32_t DynamicUniformBufferCount = 0;
+        for (auto &&i : descriptorSetLayoutBindingList)
+        {
+            if (i.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC)
+            {
+                DynamicUniformBufferCount += i.descriptorCount;
+            }
+        }
+        VkPhysicalDeviceProperties PhysicalDeviceProperties{};
+        vkGetPhysicalDeviceProperties(mDevice->GetPhysicalDevice(), &PhysicalDeviceProperties);
+        if (DynamicUniformBufferCount > PhysicalDeviceProperties.limits.maxDescriptorSetUniformBuffersDynamic)
+        {
+            throw std::runtime_error("Too many dynamic uniform buffers in descriptor set layout!");
+        }
+        mDynamicDescriptorCount = DynamicUniformBufferCount;
+
         VkDescriptorSetLayoutCreateInfo DescriptorSetLayoutCreateInfo{};
         DescriptorSetLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
         DescriptorSetLayoutCreateInfo.bindingCount = descriptorSetLayoutBindingList.size();
@@ -42,19 +59,21 @@ namespace vk
     }
     void DescriptorSetLayout::CreateDescriptorPool(uint32_t descriptorSetCount, std::vector<VkDescriptorSetLayoutBinding> descriptorSetLayoutBindingList)
     {
+        // 描述符池容量需要覆盖全部描述符集
+        uint32_t MaxSetCount = mDevice->GetFrameInFlightCount() * descriptorSetCount;
         std::vector<VkDescriptorPoolSize> DescriptorPoolSizeList;
         for (auto &&i : descriptorSetLayoutBindingList)
         {
             VkDescriptorPoolSize DescriptorPoolSize{};
             DescriptorPoolSize.type = i.descriptorType;
-            DescriptorPoolSize.descriptorCount = i.descriptorCount;
+            DescriptorPoolSize.descriptorCount = i.descriptorCount * MaxSetCount;
             DescriptorPoolSizeList.push_back(DescriptorPoolSize);
         }
         VkDescriptorPoolCreateInfo DescriptorPoolCreateInfo{};
         DescriptorPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
         DescriptorPoolCreateInfo.poolSizeCount = DescriptorPoolSizeList.size();
         DescriptorPoolCreateInfo.pPoolSizes = DescriptorPoolSizeList.data();
-        DescriptorPoolCreateInfo.maxSets = mDevice->GetSwapchainImageCount() * descriptorSetCount;
+        DescriptorPoolCreateInfo.maxSets = MaxSetCount;
         if (vkCreateDescriptorPool(mDevice->GetLogicalDevice(), &DescriptorPoolCreateInfo, nullptr, &mDescriptorPool) != VK_SUCCESS)
         {
             throw std::runtime_error("Failed to create descriptor pool!");
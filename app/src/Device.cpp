@@ -2,65 +2,45 @@
 
 namespace vk
 {
-    Device::Device(Window::Ptr window)
+    Device::Device(Window::Ptr window, uint32_t frameInFlightCount)
+        : mWindow(window), mFrameInFlightCount(std::max(1u, frameInFlightCount))
     {
         VolkInit();
         CreateInstance(window);
         CreateSurface(window);
         EnumerationPhysicalDevice();
         CreateLogicalDevice();
+        CreateMemoryAllocator();
         CreateSwapchain(window);
         CreateFrameImageView();
         CreateRenderPass();
         CreateFrameBuffer();
         CreateCommandPool();
+        CreateUploader();
+        CreatePipelineCache();
     }
     Device::~Device()
     {
+        // 管线缓存
+        if (mPipelineCache != nullptr)
+        {
+            SavePipelineCache();
+            vkDestroyPipelineCache(mLogicalDevice, mPipelineCache, nullptr);
+        }
+        // 上传器
+        mUploader.reset();
         // 命令池
         if (mCommandPool != nullptr)
         {
             vkDestroyCommandPool(mLogicalDevice, mCommandPool, nullptr);
         }
-        // 帧缓冲区
-        for (auto &&i : mFrameBufferList)
-        {
-            if (i != nullptr)
-            {
-                vkDestroyFramebuffer(mLogicalDevice, i, nullptr);
-            }
-        }
+        // 帧缓冲区与颜色、深度缓冲区
+        DestroyFrameResource();
         // 渲染流程
         if (mRenderPass != nullptr)
         {
             vkDestroyRenderPass(mLogicalDevice, mRenderPass, nullptr);
         }
-        // 深度缓冲区
-        if (mDepthImageView != nullptr)
-        {
-            vkDestroyImageView(mLogicalDevice, mDepthImageView, nullptr);
-        }
-        if (mDepthMemory != nullptr)
-        {
-            vkFreeMemory(mLogicalDevice, mDepthMemory, nullptr);
-        }
-        if (mDepthImage != nullptr)
-        {
-            vkDestroyImage(mLogicalDevice, mDepthImage, nullptr);
-        }
-        // 颜色缓冲区
-        if (mColorImageView != nullptr)
-        {
-            vkDestroyImageView(mLogicalDevice, mColorImageView, nullptr);
-        }
-        if (mColorMemory != nullptr)
-        {
-            vkFreeMemory(mLogicalDevice, mColorMemory, nullptr);
-        }
-        if (mColorImage != nullptr)
-        {
-            vkDestroyImage(mLogicalDevice, mColorImage, nullptr);
-        }
         // 交换链
         for (auto &&i : mSwapchainImageViewList)
         {
@@ -73,6 +53,8 @@ namespace vk
         {
             vkDestroySwapchainKHR(mLogicalDevice, mSwapchain, nullptr);
         }
+        // 内存分配器
+        mMemoryAllocator.reset();
         // 逻辑设备
         if (mLogicalDevice != nullptr)
         {
@@ -154,6 +136,7 @@ namespace vk
         vkGetPhysicalDeviceQueueFamilyProperties(mPhysicalDevice, &QueueFamilyPropertieCount, QueueFamilyPropertieList.data());
         std::optional<uint32_t> oGraphicsQueueFamilyIndex;
         std::optional<uint32_t> oPresentQueueFamilyIndex;
+        std::optional<uint32_t> oTransferQueueFamilyIndex;
         uint32_t QueueFamilyIndex = 0;
         for (auto &&i : QueueFamilyPropertieList)
         {
@@ -162,6 +145,14 @@ namespace vk
             {
                 oGraphicsQueueFamilyIndex = QueueFamilyIndex;
             }
+            // 传输队列族，优先选择只支持传输的队列族（通常对应独立的DMA引擎）
+            if ((i.queueFlags & VK_QUEUE_TRANSFER_BIT) && !(i.queueFlags & VK_QUEUE_GRAPHICS_BIT))
+            {
+                if (!oTransferQueueFamilyIndex.has_value() || !(i.queueFlags & VK_QUEUE_COMPUTE_BIT))
+                {
+                    oTransferQueueFamilyIndex = QueueFamilyIndex;
+                }
+            }
             // 显示队列族
             VkBool32 IsSurfaceSupport = 0;
             vkGetPhysicalDeviceSurfaceSupportKHR(mPhysicalDevice, QueueFamilyIndex, mSurface, &IsSurfaceSupport);
@@ -177,11 +168,39 @@ namespace vk
         }
         mGraphicsQueueFamilyIndex = oGraphicsQueueFamilyIndex.value();
         mPresentQueueFamilyIndex = oPresentQueueFamilyIndex.value();
+        mTransferQueueFamilyIndex = oTransferQueueFamilyIndex.value_or(mGraphicsQueueFamilyIndex);
 
         // 创建逻辑设备
-        VkPhysicalDeviceFeatures PhysicalDeviceFeatures{};
-        PhysicalDeviceFeatures.samplerAnisotropy = VK_TRUE;
-        PhysicalDeviceFeatures.sampleRateShading = VK_TRUE;
+        VkPhysicalDeviceFeatures SupportedFeatures{};
+        vkGetPhysicalDeviceFeatures(mPhysicalDevice, &SupportedFeatures);
+        mDeviceFeatures.samplerAnisotropy = VK_TRUE;
+        mDeviceFeatures.sampleRateShading = VK_TRUE;
+        // 模型片段着色器写入纹理流送的反馈，不支持时不使用反馈
+        mDeviceFeatures.fragmentStoresAndAtomics = SupportedFeatures.fragmentStoresAndAtomics;
+        // 间接绘制与纹理数组的动态索引
+        mDeviceFeatures.multiDrawIndirect = SupportedFeatures.multiDrawIndirect;
+        mDeviceFeatures.drawIndirectFirstInstance = SupportedFeatures.drawIndirectFirstInstance;
+        mDeviceFeatures.shaderSampledImageArrayDynamicIndexing = SupportedFeatures.shaderSampledImageArrayDynamicIndexing;
+        // 离线烘焙的BC压缩纹理，不支持时回退到原始图像
+        mDeviceFeatures.textureCompressionBC = SupportedFeatures.textureCompressionBC;
+        // Vulkan1.2特性，设备版本低于1.2时不能使用
+        VkPhysicalDeviceProperties PhysicalDeviceProperties{};
+        vkGetPhysicalDeviceProperties(mPhysicalDevice, &PhysicalDeviceProperties);
+        mDeviceVulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+        bool IsVulkan12 = PhysicalDeviceProperties.apiVersion >= VK_API_VERSION_1_2;
+        if (IsVulkan12)
+        {
+            VkPhysicalDeviceVulkan12Features SupportedVulkan12Features{};
+            SupportedVulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+            VkPhysicalDeviceFeatures2 SupportedFeatures2{};
+            SupportedFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            SupportedFeatures2.pNext = &SupportedVulkan12Features;
+            vkGetPhysicalDeviceFeatures2(mPhysicalDevice, &SupportedFeatures2);
+            // 剔除后的绘制数量
+            mDeviceVulkan12Features.drawIndirectCount = SupportedVulkan12Features.drawIndirectCount;
+            // 多绘制间接中各绘制的纹理索引不是动态一致的
+            mDeviceVulkan12Features.shaderSampledImageArrayNonUniformIndexing = SupportedVulkan12Features.shaderSampledImageArrayNonUniformIndexing;
+        }
 
         std::vector<const char *> DeviceExtensionList = {
             VK_KHR_SWAPCHAIN_EXTENSION_NAME,
@@ -191,6 +210,7 @@ namespace vk
         std::set<uint32_t> sQueueFamilyIndexList = {
             mGraphicsQueueFamilyIndex,
             mPresentQueueFamilyIndex,
+            mTransferQueueFamilyIndex,
         };
         float QueuePrioritie = 1.0f;
         for (auto &&i : sQueueFamilyIndexList)
@@ -204,7 +224,8 @@ namespace vk
         }
         VkDeviceCreateInfo DeviceCreateInfo{};
         DeviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-        DeviceCreateInfo.pEnabledFeatures = &PhysicalDeviceFeatures;
+        DeviceCreateInfo.pEnabledFeatures = &mDeviceFeatures;
+        DeviceCreateInfo.pNext = IsVulkan12 ? &mDeviceVulkan12Features : nullptr;
         DeviceCreateInfo.enabledExtensionCount = DeviceExtensionList.size();
         DeviceCreateInfo.ppEnabledExtensionNames = DeviceExtensionList.data();
         DeviceCreateInfo.queueCreateInfoCount = QueueCreateInfoList.size();
@@ -219,6 +240,11 @@ namespace vk
         // 获取队列句柄
         vkGetDeviceQueue(mLogicalDevice, mGraphicsQueueFamilyIndex, 0, &mGraphicsQueue);
         vkGetDeviceQueue(mLogicalDevice, mPresentQueueFamilyIndex, 0, &mPresentQueue);
+        vkGetDeviceQueue(mLogicalDevice, mTransferQueueFamilyIndex, 0, &mTransferQueue);
+    }
+    void Device::CreateMemoryAllocator()
+    {
+        mMemoryAllocator = MemoryAllocator::New(mPhysicalDevice, mLogicalDevice);
     }
     void Device::CreateSwapchain(Window::Ptr window)
     {
@@ -305,7 +331,9 @@ namespace vk
         // 创建交换链
         VkSwapchainCreateInfoKHR SwapchainCreateInfo{};
         SwapchainCreateInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
-        SwapchainCreateInfo.oldSwapchain = nullptr;
+        // 重建时传入旧交换链，以便驱动复用资源
+        VkSwapchainKHR OldSwapchain = mSwapchain;
+        SwapchainCreateInfo.oldSwapchain = OldSwapchain;
         SwapchainCreateInfo.imageArrayLayers = 1;
         SwapchainCreateInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
         SwapchainCreateInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
@@ -342,6 +370,16 @@ namespace vk
         {
             throw std::runtime_error("Failed to create exchange chain!");
         }
+        // 销毁旧交换链及其图像视图
+        for (auto &&i : mSwapchainImageViewList)
+        {
+            vkDestroyImageView(mLogicalDevice, i, nullptr);
+        }
+        mSwapchainImageViewList.clear();
+        if (OldSwapchain != nullptr)
+        {
+            vkDestroySwapchainKHR(mLogicalDevice, OldSwapchain, nullptr);
+        }
 
         // 创建交换链视图
         uint32_t ImageCount = 0;
@@ -537,6 +575,42 @@ namespace vk
             }
         }
     }
+    void Device::DestroyFrameResource()
+    {
+        // 帧缓冲区
+        for (auto &&i : mFrameBufferList)
+        {
+            if (i != nullptr)
+            {
+                vkDestroyFramebuffer(mLogicalDevice, i, nullptr);
+            }
+        }
+        mFrameBufferList.clear();
+        // 深度缓冲区
+        if (mDepthImageView != nullptr)
+        {
+            vkDestroyImageView(mLogicalDevice, mDepthImageView, nullptr);
+            mDepthImageView = nullptr;
+        }
+        if (mDepthImage != nullptr)
+        {
+            vkDestroyImage(mLogicalDevice, mDepthImage, nullptr);
+            mDepthImage = nullptr;
+        }
+        FreeMemory(&mDepthMemory);
+        // 颜色缓冲区
+        if (mColorImageView != nullptr)
+        {
+            vkDestroyImageView(mLogicalDevice, mColorImageView, nullptr);
+            mColorImageView = nullptr;
+        }
+        if (mColorImage != nullptr)
+        {
+            vkDestroyImage(mLogicalDevice, mColorImage, nullptr);
+            mColorImage = nullptr;
+        }
+        FreeMemory(&mColorMemory);
+    }
     void Device::CreateCommandPool()
     {
         VkCommandPoolCreateInfo CommandPoolCreateInfo{};
@@ -549,6 +623,105 @@ namespace vk
         }
     }
 
+    void Device::CreateUploader()
+    {
+        mUploader = Uploader::New(this);
+    }
+
+    void Device::CreatePipelineCache()
+    {
+        // 读取磁盘上的管线缓存
+        std::vector<char> CacheData;
+        std::fstream CacheFile(mPipelineCacheFilePath, std::ios::ate | std::ios::binary | std::ios::in);
+        if (CacheFile.is_open())
+        {
+            size_t CacheFileSize = CacheFile.tellg();
+            CacheFile.seekg(0);
+            CacheData.resize(CacheFileSize, 0);
+            CacheFile.read(CacheData.data(), CacheFileSize);
+            CacheFile.close();
+        }
+        // 驱动或设备发生变化时缓存无效，丢弃后重新编译
+        if (!IsPipelineCacheValid(CacheData))
+        {
+            CacheData.clear();
+        }
+
+        VkPipelineCacheCreateInfo PipelineCacheCreateInfo{};
+        PipelineCacheCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        PipelineCacheCreateInfo.initialDataSize = CacheData.size();
+        PipelineCacheCreateInfo.pInitialData = CacheData.empty() ? nullptr : CacheData.data();
+        if (vkCreatePipelineCache(mLogicalDevice, &PipelineCacheCreateInfo, nullptr, &mPipelineCache) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to create pipeline cache!");
+        }
+        mPipelineCacheLoadSize = CacheData.size();
+    }
+    bool Device::IsPipelineCacheValid(const std::vector<char> &cacheData)
+    {
+        if (cacheData.size() < sizeof(VkPipelineCacheHeaderVersionOne))
+        {
+            return false;
+        }
+        VkPipelineCacheHeaderVersionOne CacheHeader{};
+        memcpy(&CacheHeader, cacheData.data(), sizeof(CacheHeader));
+        VkPhysicalDeviceProperties PhysicalDeviceProperties{};
+        vkGetPhysicalDeviceProperties(mPhysicalDevice, &PhysicalDeviceProperties);
+        if (CacheHeader.headerSize < sizeof(CacheHeader) || CacheHeader.headerSize > cacheData.size() ||
+            CacheHeader.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+            CacheHeader.vendorID != PhysicalDeviceProperties.vendorID ||
+            CacheHeader.deviceID != PhysicalDeviceProperties.deviceID ||
+            memcmp(CacheHeader.pipelineCacheUUID, PhysicalDeviceProperties.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+        {
+            return false;
+        }
+        return true;
+    }
+    void Device::SavePipelineCache()
+    {
+        size_t CacheDataSize = 0;
+        if (vkGetPipelineCacheData(mLogicalDevice, mPipelineCache, &CacheDataSize, nullptr) != VK_SUCCESS || CacheDataSize == 0)
+        {
+            return;
+        }
+        std::vector<char> CacheData(CacheDataSize);
+        if (vkGetPipelineCacheData(mLogicalDevice, mPipelineCache, &CacheDataSize, CacheData.data()) != VK_SUCCESS)
+        {
+            return;
+        }
+        // 先写入临时文件再替换，避免中途退出留下损坏的缓存
+        std::string TempFilePath = mPipelineCacheFilePath + ".tmp";
+        std::fstream CacheFile(TempFilePath, std::ios::binary | std::ios::out | std::ios::trunc);
+        if (!CacheFile.is_open())
+        {
+            return;
+        }
+        CacheFile.write(CacheData.data(), CacheDataSize);
+        CacheFile.close();
+        std::remove(mPipelineCacheFilePath.c_str());
+        std::rename(TempFilePath.c_str(), mPipelineCacheFilePath.c_str());
+    }
+
+    bool Device::RecreateSwapchain()
+    {
+        // 窗口最小化时帧缓冲区大小为0，无法创建交换链
+        int Width = 0, Height = 0;
+        mWindow->GetFrameBufferSize(&Width, &Height);
+        if (Width == 0 || Height == 0)
+        {
+            return false;
+        }
+        std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+        // 等待使用中的附件执行完毕，渲染流程与管线与尺寸无关，不需要重建
+        DeviceWaitIdle();
+        DestroyFrameResource();
+        CreateSwapchain(mWindow);
+        CreateFrameImageView();
+        CreateFrameBuffer();
+        mSwapchainRecreateCount++;
+        mSwapchainRecreateTime = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::steady_clock::now() - StartTime).count();
+        return true;
+    }
     bool Device::DeviceWaitIdle()
     {
         if (vkDeviceWaitIdle(mLogicalDevice) != VK_SUCCESS)
@@ -569,6 +742,28 @@ namespace vk
         }
         return true;
     }
+    bool Device::AllocateMemory(VkMemoryRequirements memoryRequirements, VkMemoryPropertyFlags properties, MemoryAllocator::ResourceType type, MemoryAllocator::Allocation *allocation)
+    {
+        // 获取合适的内存类型索引
+        uint32_t MemoryTypeIndex = 0;
+        if (!QueryMemoryTypeIndex(memoryRequirements, properties, &MemoryTypeIndex))
+        {
+            return false;
+        }
+        // 从内存分配器中子分配
+        if (!mMemoryAllocator->Allocate(memoryRequirements, MemoryTypeIndex, type, allocation))
+        {
+            return false;
+        }
+        return true;
+    }
+    void Device::FreeMemory(MemoryAllocator::Allocation *allocation)
+    {
+        if (mMemoryAllocator != nullptr)
+        {
+            mMemoryAllocator->Free(allocation);
+        }
+    }
     bool Device::CreateImageView(VkImage image, VkFormat format, VkImageViewType viewType,
                                  VkImageAspectFlags aspectFlags, uint32_t levelCount, uint32_t layerCount, VkImageView *imageView)
     {
@@ -586,7 +781,7 @@ namespace vk
         }
         return true;
     }
-    bool Device::CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, uint64_t size)
+    bool Device::CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, uint64_t size, VkDeviceSize srcOffset, VkDeviceSize dstOffset)
     {
         VkCommandBuffer CommandBuffer;
         if (!CreateDisposableCommandBuffer(&CommandBuffer))
@@ -596,6 +791,8 @@ namespace vk
 
         // 拷贝缓冲区命令
         VkBufferCopy BufferCopy{};
+        BufferCopy.srcOffset = srcOffset;
+        BufferCopy.dstOffset = dstOffset;
         BufferCopy.size = size;
         vkCmdCopyBuffer(CommandBuffer, srcBuffer, dstBuffer, 1, &BufferCopy);
 
@@ -636,7 +833,7 @@ namespace vk
         }
         return true;
     }
-    bool Device::CopyBufferToImage(VkBuffer srcBuffer,
+    bool Device::CopyBufferToImage(VkBuffer srcBuffer, VkDeviceSize srcOffset,
                                    VkImage dstImage, VkImageAspectFlags dstAspectFlags, uint32_t dstMipLevel, uint32_t dstLayerCount, VkImageLayout dstImageLayout,
                                    uint32_t width, uint32_t height)
     {
@@ -647,7 +844,7 @@ namespace vk
         }
 
         VkBufferImageCopy BufferImageCopy{};
-        BufferImageCopy.bufferOffset = 0;
+        BufferImageCopy.bufferOffset = srcOffset;
         BufferImageCopy.bufferRowLength = 0;
         BufferImageCopy.bufferImageHeight = 0;
         BufferImageCopy.imageOffset = {0, 0, 0};
@@ -666,46 +863,229 @@ namespace vk
     }
     bool Device::CreateDisposableCommandBuffer(VkCommandBuffer *commandBuffer)
     {
-        VkCommandBufferAllocateInfo CommandBufferAllocateInfo{};
-        CommandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        CommandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-        CommandBufferAllocateInfo.commandPool = mCommandPool;
-        CommandBufferAllocateInfo.commandBufferCount = 1;
-        if (vkAllocateCommandBuffers(mLogicalDevice, &CommandBufferAllocateInfo, commandBuffer) != VK_SUCCESS)
+        if (!mUploader->Begin())
         {
             return false;
         }
+        *commandBuffer = mUploader->GetCommandBuffer();
+        return true;
+    }
+    bool Device::EndDisposableCommandBuffer(VkCommandBuffer *commandBuffer)
+    {
+        uint64_t Ticket = 0;
+        if (!mUploader->End(&Ticket))
+        {
+            return false;
+        }
+        // 最外层批次提交后等待围栏，嵌套在外部批次中时由外部统一等待
+        if (Ticket != 0 && !mUploader->Wait(Ticket))
+        {
+            return false;
+        }
+        *commandBuffer = nullptr;
+        return true;
+    }
+    bool Device::UploadBuffer(VkBuffer srcBuffer, VkDeviceSize srcOffset, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize dstOffset)
+    {
+        VkCommandBuffer CommandBuffer;
+        if (!CreateDisposableCommandBuffer(&CommandBuffer))
+        {
+            return false;
+        }
+        VkCommandBuffer TransferCommandBuffer = mUploader->GetTransferCommandBuffer();
 
-        VkCommandBufferBeginInfo CommandBufferBeginInfo{};
-        CommandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        CommandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-        if (vkBeginCommandBuffer(*commandBuffer, &CommandBufferBeginInfo) != VK_SUCCESS)
+        // 拷贝缓冲区命令
+        VkBufferCopy BufferCopy{};
+        BufferCopy.srcOffset = srcOffset;
+        BufferCopy.dstOffset = dstOffset;
+        BufferCopy.size = size;
+        vkCmdCopyBuffer(TransferCommandBuffer, srcBuffer, dstBuffer, 1, &BufferCopy);
+
+        // 传输队列释放所有权，图形队列获取所有权，两者的屏障参数需一致
+        // 同一批次可能多次写入同一缓冲区的不同区域，屏障只覆盖本次写入的区域，每次释放与获取成对
+        if (IsHaveDedicatedTransferQueue())
+        {
+            VkBufferMemoryBarrier BufferMemoryBarrier{};
+            BufferMemoryBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            BufferMemoryBarrier.srcQueueFamilyIndex = mTransferQueueFamilyIndex;
+            BufferMemoryBarrier.dstQueueFamilyIndex = mGraphicsQueueFamilyIndex;
+            BufferMemoryBarrier.buffer = dstBuffer;
+            BufferMemoryBarrier.offset = dstOffset;
+            BufferMemoryBarrier.size = size;
+
+            BufferMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            BufferMemoryBarrier.dstAccessMask = 0;
+            vkCmdPipelineBarrier(TransferCommandBuffer,
+                                 VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+                                 0, nullptr,
+                                 1, &BufferMemoryBarrier,
+                                 0, nullptr);
+            //
+            BufferMemoryBarrier.srcAccessMask = 0;
+            BufferMemoryBarrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT |
+                                                VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+            vkCmdPipelineBarrier(CommandBuffer,
+                                 VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                 VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                                 0, nullptr,
+                                 1, &BufferMemoryBarrier,
+                                 0, nullptr);
+            //
+        }
+
+        if (!EndDisposableCommandBuffer(&CommandBuffer))
         {
             return false;
         }
         return true;
     }
-    bool Device::EndDisposableCommandBuffer(VkCommandBuffer *commandBuffer)
+    bool Device::UploadImage(VkBuffer srcBuffer, VkDeviceSize srcOffset,
+                             VkImage dstImage, VkImageAspectFlags dstAspectFlags, uint32_t levelCount, uint32_t layerCount,
+                             uint32_t width, uint32_t height)
     {
-        if (vkEndCommandBuffer(*commandBuffer) != VK_SUCCESS)
+        VkCommandBuffer CommandBuffer;
+        if (!CreateDisposableCommandBuffer(&CommandBuffer))
         {
             return false;
         }
+        VkCommandBuffer TransferCommandBuffer = mUploader->GetTransferCommandBuffer();
 
-        VkSubmitInfo SubmitInfo{};
-        SubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        SubmitInfo.commandBufferCount = 1;
-        SubmitInfo.pCommandBuffers = commandBuffer;
-        if (vkQueueSubmit(mGraphicsQueue, 1, &SubmitInfo, nullptr) != VK_SUCCESS)
+        // 原有内容会被完整覆盖，直接从未定义布局转换为传输目标位
+        VkImageMemoryBarrier ImageMemoryBarrier{};
+        ImageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        ImageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        ImageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        ImageMemoryBarrier.image = dstImage;
+        ImageMemoryBarrier.subresourceRange.aspectMask = dstAspectFlags;
+        ImageMemoryBarrier.subresourceRange.levelCount = levelCount;
+        ImageMemoryBarrier.subresourceRange.layerCount = layerCount;
+        ImageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        ImageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        ImageMemoryBarrier.srcAccessMask = 0;
+        ImageMemoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(TransferCommandBuffer,
+                             VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                             0, nullptr,
+                             0, nullptr,
+                             1, &ImageMemoryBarrier);
+        //
+
+        // 拷贝原图级别
+        VkBufferImageCopy BufferImageCopy{};
+        BufferImageCopy.bufferOffset = srcOffset;
+        BufferImageCopy.imageSubresource.aspectMask = dstAspectFlags;
+        BufferImageCopy.imageSubresource.mipLevel = 0;
+        BufferImageCopy.imageSubresource.baseArrayLayer = 0;
+        BufferImageCopy.imageSubresource.layerCount = layerCount;
+        BufferImageCopy.imageExtent = {width, height, 1};
+        vkCmdCopyBufferToImage(TransferCommandBuffer, srcBuffer, dstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &BufferImageCopy);
+
+        // 传输队列释放所有权，图形队列获取所有权，布局保持为传输目标位供生成mip
+        if (IsHaveDedicatedTransferQueue())
+        {
+            ImageMemoryBarrier.srcQueueFamilyIndex = mTransferQueueFamilyIndex;
+            ImageMemoryBarrier.dstQueueFamilyIndex = mGraphicsQueueFamilyIndex;
+            ImageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            ImageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+
+            ImageMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            ImageMemoryBarrier.dstAccessMask = 0;
+            vkCmdPipelineBarrier(TransferCommandBuffer,
+                                 VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+                                 0, nullptr,
+                                 0, nullptr,
+                                 1, &ImageMemoryBarrier);
+            //
+            ImageMemoryBarrier.srcAccessMask = 0;
+            ImageMemoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+            vkCmdPipelineBarrier(CommandBuffer,
+                                 VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                                 0, nullptr,
+                                 0, nullptr,
+                                 1, &ImageMemoryBarrier);
+            //
+        }
+
+        if (!EndDisposableCommandBuffer(&CommandBuffer))
         {
             return false;
         }
+        return true;
+    }
+    bool Device::UploadImageLevels(VkBuffer srcBuffer, const std::vector<VkBufferImageCopy> &bufferImageCopyList,
+                                   VkImage dstImage, VkImageAspectFlags dstAspectFlags, uint32_t levelCount, uint32_t layerCount)
+    {
+        VkCommandBuffer CommandBuffer;
+        if (!CreateDisposableCommandBuffer(&CommandBuffer))
+        {
+            return false;
+        }
+        VkCommandBuffer TransferCommandBuffer = mUploader->GetTransferCommandBuffer();
+
+        // 原有内容会被完整覆盖，直接从未定义布局转换为传输目标位
+        VkImageMemoryBarrier ImageMemoryBarrier{};
+        ImageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        ImageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        ImageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        ImageMemoryBarrier.image = dstImage;
+        ImageMemoryBarrier.subresourceRange.aspectMask = dstAspectFlags;
+        ImageMemoryBarrier.subresourceRange.levelCount = levelCount;
+        ImageMemoryBarrier.subresourceRange.layerCount = layerCount;
+        ImageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        ImageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        ImageMemoryBarrier.srcAccessMask = 0;
+        ImageMemoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(TransferCommandBuffer,
+                             VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                             0, nullptr,
+                             0, nullptr,
+                             1, &ImageMemoryBarrier);
+        //
+
+        // 一次拷贝所有mip级别
+        vkCmdCopyBufferToImage(TransferCommandBuffer, srcBuffer, dstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, bufferImageCopyList.size(), bufferImageCopyList.data());
+
+        // 不需要生成mip，直接转换为着色器只读位，有独立传输队列时同时转移所有权
+        ImageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        ImageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        if (IsHaveDedicatedTransferQueue())
+        {
+            ImageMemoryBarrier.srcQueueFamilyIndex = mTransferQueueFamilyIndex;
+            ImageMemoryBarrier.dstQueueFamilyIndex = mGraphicsQueueFamilyIndex;
+
+            ImageMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            ImageMemoryBarrier.dstAccessMask = 0;
+            vkCmdPipelineBarrier(TransferCommandBuffer,
+                                 VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+                                 0, nullptr,
+                                 0, nullptr,
+                                 1, &ImageMemoryBarrier);
+            //
+            ImageMemoryBarrier.srcAccessMask = 0;
+            ImageMemoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            vkCmdPipelineBarrier(CommandBuffer,
+                                 VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+                                 0, nullptr,
+                                 0, nullptr,
+                                 1, &ImageMemoryBarrier);
+            //
+        }
+        else
+        {
+            ImageMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            ImageMemoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            vkCmdPipelineBarrier(CommandBuffer,
+                                 VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+                                 0, nullptr,
+                                 0, nullptr,
+                                 1, &ImageMemoryBarrier);
+            //
+        }
 
-        if (vkQueueWaitIdle(mGraphicsQueue) != VK_SUCCESS)
+        if (!EndDisposableCommandBuffer(&CommandBuffer))
         {
             return false;
         }
-        vkFreeCommandBuffers(mLogicalDevice, mCommandPool, 1, commandBuffer);
         return true;
     }
     void Device::GetMaxUsableSampleCount(VkSampleCountFlagBits *sampleCount)
@@ -793,7 +1173,7 @@ namespace vk
                              VkFormat format, VkImageType imageType, VkSampleCountFlagBits numSamples,
                              VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties,
                              uint32_t mipLevels, uint32_t layerCount,
-                             VkImage *image, VkDeviceMemory *imageMemory)
+                             VkImage *image, MemoryAllocator::Allocation *imageMemory)
     {
         VkImageCreateInfo ImageCreateInfo{};
         ImageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -814,26 +1194,23 @@ namespace vk
             return false;
         }
 
-        // 获取合适的内存类型索引
+        // 分配内存
         VkMemoryRequirements MemoryRequirements;
         vkGetImageMemoryRequirements(mLogicalDevice, *image, &MemoryRequirements);
-        uint32_t MemoryTypeIndex = 0;
-        if (!QueryMemoryTypeIndex(MemoryRequirements, properties, &MemoryTypeIndex))
+        MemoryAllocator::ResourceType ResourceType = tiling == VK_IMAGE_TILING_OPTIMAL ? MemoryAllocator::ResourceType::Optimal : MemoryAllocator::ResourceType::Linear;
+        if (!AllocateMemory(MemoryRequirements, properties, ResourceType, imageMemory))
         {
             return false;
         }
 
-        // 分配内存
-        if (!AllocateMemory(MemoryRequirements, MemoryTypeIndex, imageMemory))
+        // 绑定内存
+        if (vkBindImageMemory(mLogicalDevice, *image, imageMemory->Memory, imageMemory->Offset) != VK_SUCCESS)
         {
             return false;
         }
-
-        // 绑定内存
-        vkBindImageMemory(mLogicalDevice, *image, *imageMemory, 0);
         return true;
     }
-    bool Device::CreateBuffer(uint64_t bufferSize, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer *buffer, VkDeviceMemory *bufferMemory)
+    bool Device::CreateBuffer(uint64_t bufferSize, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer *buffer, MemoryAllocator::Allocation *bufferMemory)
     {
         // 创建缓冲区
         VkBufferCreateInfo BufferCreateInfo{};
@@ -846,23 +1223,16 @@ namespace vk
             return false;
         }
 
-        // 获取合适的内存类型索引
+        // 分配内存
         VkMemoryRequirements MemoryRequirements;
         vkGetBufferMemoryRequirements(mLogicalDevice, *buffer, &MemoryRequirements);
-        uint32_t MemoryTypeIndex = 0;
-        if (!QueryMemoryTypeIndex(MemoryRequirements, properties, &MemoryTypeIndex))
-        {
-            return false;
-        }
-
-        // 分配内存
-        if (!AllocateMemory(MemoryRequirements, MemoryTypeIndex, bufferMemory))
+        if (!AllocateMemory(MemoryRequirements, properties, MemoryAllocator::ResourceType::Linear, bufferMemory))
         {
             return false;
         }
 
         // 绑定内存
-        if (vkBindBufferMemory(mLogicalDevice, *buffer, *bufferMemory, 0) != VK_SUCCESS)
+        if (vkBindBufferMemory(mLogicalDevice, *buffer, bufferMemory->Memory, bufferMemory->Offset) != VK_SUCCESS)
         {
             return false;
         }
@@ -0,0 +1,196 @@
+#include "vk/FrustumCuller.h"
+
+#include <random>
+#include <limits>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VK_FRUSTUM_CULLER_SSE
+#endif
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace vk
+{
+    FrustumCuller::FrustumCuller()
+    {
+    }
+    FrustumCuller::~FrustumCuller()
+    {
+    }
+
+    std::array<glm::vec4, 6> FrustumCuller::ExtractPlane(const glm::mat4 &viewProjectionMat)
+    {
+        // 矩阵的行，glm按列存储
+        glm::mat4 Mat = glm::transpose(viewProjectionMat);
+        // 深度范围为0到1，近平面为第三行
+        std::array<glm::vec4, 6> PlaneList{Mat[3] + Mat[0], Mat[3] - Mat[0], Mat[3] + Mat[1], Mat[3] - Mat[1], Mat[2], Mat[3] - Mat[2]};
+        for (auto &&i : PlaneList)
+        {
+            i /= glm::length(glm::vec3(i));
+        }
+        return PlaneList;
+    }
+    void FrustumCuller::CullScalar(const std::array<glm::vec4, 6> &planeList, uint32_t begin, uint32_t end, std::vector<uint32_t> &visibleIndexList)
+    {
+        for (uint32_t i = begin; i < end; i++)
+        {
+            bool Visible = true;
+            for (auto &&j : planeList)
+            {
+                if (j.x * mCenterXList[i] + j.y * mCenterYList[i] + j.z * mCenterZList[i] + j.w < -mRadiusList[i])
+                {
+                    Visible = false;
+                    break;
+                }
+            }
+            if (Visible)
+            {
+                visibleIndexList.push_back(i);
+            }
+        }
+    }
+    void FrustumCuller::CullSSE(const std::array<glm::vec4, 6> &planeList, std::vector<uint32_t> &visibleIndexList)
+    {
+#if defined(VK_FRUSTUM_CULLER_SSE)
+        __m128 PlaneX[6], PlaneY[6], PlaneZ[6], PlaneW[6];
+        for (uint32_t i = 0; i < 6; i++)
+        {
+            PlaneX[i] = _mm_set1_ps(planeList[i].x);
+            PlaneY[i] = _mm_set1_ps(planeList[i].y);
+            PlaneZ[i] = _mm_set1_ps(planeList[i].z);
+            PlaneW[i] = _mm_set1_ps(planeList[i].w);
+        }
+        for (uint32_t i = 0; i < mSphereCount; i += 4)
+        {
+            __m128 CenterX = _mm_loadu_ps(&mCenterXList[i]);
+            __m128 CenterY = _mm_loadu_ps(&mCenterYList[i]);
+            __m128 CenterZ = _mm_loadu_ps(&mCenterZList[i]);
+            __m128 NegativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&mRadiusList[i]));
+            __m128 Mask = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (uint32_t j = 0; j < 6; j++)
+            {
+                __m128 Distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(PlaneX[j], CenterX), _mm_mul_ps(PlaneY[j], CenterY)),
+                                             _mm_add_ps(_mm_mul_ps(PlaneZ[j], CenterZ), PlaneW[j]));
+                //
+                Mask = _mm_and_ps(Mask, _mm_cmpge_ps(Distance, NegativeRadius));
+            }
+            int VisibleMask = _mm_movemask_ps(Mask);
+            for (uint32_t j = 0; VisibleMask != 0; j++, VisibleMask >>= 1)
+            {
+                if (VisibleMask & 1)
+                {
+                    visibleIndexList.push_back(i + j);
+                }
+            }
+        }
+#else
+        CullScalar(planeList, 0, mSphereCount, visibleIndexList);
+#endif
+    }
+
+    uint32_t FrustumCuller::Add(glm::vec4 sphere)
+    {
+        // 按通道数量对齐扩充存储
+        if (mSphereCount == mRadiusList.size())
+        {
+            mCenterXList.resize(mSphereCount + mLaneCount, 0.0f);
+            mCenterYList.resize(mSphereCount + mLaneCount, 0.0f);
+            mCenterZList.resize(mSphereCount + mLaneCount, 0.0f);
+            mRadiusList.resize(mSphereCount + mLaneCount, -std::numeric_limits<float>::infinity());
+        }
+        Set(mSphereCount, sphere);
+        return mSphereCount++;
+    }
+    void FrustumCuller::Set(uint32_t index, glm::vec4 sphere)
+    {
+        mCenterXList[index] = sphere.x;
+        mCenterYList[index] = sphere.y;
+        mCenterZList[index] = sphere.z;
+        mRadiusList[index] = sphere.w;
+    }
+    void FrustumCuller::Clear()
+    {
+        mCenterXList.clear();
+        mCenterYList.clear();
+        mCenterZList.clear();
+        mRadiusList.clear();
+        mSphereCount = 0;
+    }
+    void FrustumCuller::Cull(const glm::mat4 &viewProjectionMat, std::vector<uint32_t> &visibleIndexList)
+    {
+        visibleIndexList.clear();
+        // AVX版本在单独的文件中编译，运行时确认处理器支持后才调用
+        if (IsAVXSupported())
+        {
+            std::array<glm::vec4, 6> PlaneList = ExtractPlane(viewProjectionMat);
+            visibleIndexList.resize(mRadiusList.size());
+            uint32_t VisibleCount = CullAVX(&PlaneList[0].x, mCenterXList.data(), mCenterYList.data(), mCenterZList.data(),
+                                            mRadiusList.data(), mSphereCount, visibleIndexList.data());
+            visibleIndexList.resize(VisibleCount);
+        }
+        else
+        {
+            CullSSE(ExtractPlane(viewProjectionMat), visibleIndexList);
+        }
+    }
+    bool FrustumCuller::IsAVXSupported()
+    {
+        static const bool IsSupported = []()
+        {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+            // 处理器支持AVX与OSXSAVE，且操作系统保存YMM寄存器
+            int CpuInfo[4]{};
+            __cpuid(CpuInfo, 1);
+            bool IsCpuSupported = (CpuInfo[2] & (1 << 28)) && (CpuInfo[2] & (1 << 27));
+            return IsCpuSupported && (_xgetbv(0) & 0x6) == 0x6;
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx") != 0;
+#else
+            return false;
+#endif
+        }();
+        return IsSupported && IsAVXCompiled();
+    }
+    const char *FrustumCuller::GetInstructionSet()
+    {
+        if (IsAVXSupported())
+        {
+            return "AVX";
+        }
+#if defined(VK_FRUSTUM_CULLER_SSE)
+        return "SSE";
+#else
+        return "Scalar";
+#endif
+    }
+
+    float FrustumCuller::Benchmark(uint32_t sphereCount)
+    {
+        // 包围球随机分布在相机周围，部分位于视锥体内
+        FrustumCuller Culler;
+        std::mt19937 Random(0);
+        std::uniform_real_distribution<float> Position(-100.0f, 100.0f);
+        std::uniform_real_distribution<float> Radius(0.1f, 2.0f);
+        for (uint32_t i = 0; i < sphereCount; i++)
+        {
+            Culler.Add(glm::vec4(Position(Random), Position(Random), Position(Random), Radius(Random)));
+        }
+        glm::mat4 ViewProjectionMat = glm::perspective(glm::radians(90.0f), 16.0f / 9.0f, 0.1f, 1000.0f) *
+                                      glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        //
+        std::vector<uint32_t> VisibleIndexList;
+        VisibleIndexList.reserve(sphereCount);
+        // 预热一次，之后取多次的平均值
+        Culler.Cull(ViewProjectionMat, VisibleIndexList);
+        const uint32_t RepeatCount = 10;
+        std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < RepeatCount; i++)
+        {
+            Culler.Cull(ViewProjectionMat, VisibleIndexList);
+        }
+        float Time = std::chrono::duration<float, std::chrono::seconds::period>(std::chrono::steady_clock::now() - StartTime).count();
+        return Time > 0.0f ? static_cast<float>(sphereCount) * RepeatCount / Time / 1000000.0f : 0.0f;
+    }
+} // namespace vk
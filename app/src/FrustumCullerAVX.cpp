@@ -0,0 +1,59 @@
+#include "vk/FrustumCuller.h"
+
+// 本文件在x86上单独以AVX编译，其余文件保持基础指令集，调用前由IsAVXSupported在运行时确认
+// 只使用裸指针，避免以AVX实例化的std内联函数被链接器选中，在不支持的处理器上执行
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+namespace vk
+{
+    uint32_t FrustumCuller::CullAVX(const float *planeList, const float *centerXList, const float *centerYList, const float *centerZList,
+                                    const float *radiusList, uint32_t sphereCount, uint32_t *visibleIndexList)
+    {
+        uint32_t VisibleCount = 0;
+#if defined(__AVX__)
+        // 平面分量广播到全部通道
+        __m256 PlaneX[6], PlaneY[6], PlaneZ[6], PlaneW[6];
+        for (uint32_t i = 0; i < 6; i++)
+        {
+            PlaneX[i] = _mm256_set1_ps(planeList[i * 4 + 0]);
+            PlaneY[i] = _mm256_set1_ps(planeList[i * 4 + 1]);
+            PlaneZ[i] = _mm256_set1_ps(planeList[i * 4 + 2]);
+            PlaneW[i] = _mm256_set1_ps(planeList[i * 4 + 3]);
+        }
+        for (uint32_t i = 0; i < sphereCount; i += 8)
+        {
+            __m256 CenterX = _mm256_loadu_ps(centerXList + i);
+            __m256 CenterY = _mm256_loadu_ps(centerYList + i);
+            __m256 CenterZ = _mm256_loadu_ps(centerZList + i);
+            __m256 NegativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(radiusList + i));
+            __m256 Mask = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            for (uint32_t j = 0; j < 6; j++)
+            {
+                __m256 Distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(PlaneX[j], CenterX), _mm256_mul_ps(PlaneY[j], CenterY)),
+                                                _mm256_add_ps(_mm256_mul_ps(PlaneZ[j], CenterZ), PlaneW[j]));
+                //
+                Mask = _mm256_and_ps(Mask, _mm256_cmp_ps(Distance, NegativeRadius, _CMP_GE_OQ));
+            }
+            int VisibleMask = _mm256_movemask_ps(Mask);
+            for (uint32_t j = 0; VisibleMask != 0; j++, VisibleMask >>= 1)
+            {
+                if (VisibleMask & 1)
+                {
+                    visibleIndexList[VisibleCount++] = i + j;
+                }
+            }
+        }
+#endif
+        return VisibleCount;
+    }
+    bool FrustumCuller::IsAVXCompiled()
+    {
+#if defined(__AVX__)
+        return true;
+#else
+        return false;
+#endif
+    }
+} // namespace vk
@@ -0,0 +1,53 @@
+#include "vk/GeometryPool.h"
+
+namespace vk
+{
+    GeometryPool::GeometryPool(Device::Ptr device, uint32_t vertexStride, uint32_t vertexCapacity, uint32_t indexCapacity)
+        : mDevice(device), mVertexStride(vertexStride), mVertexCapacity(vertexCapacity), mIndexCapacity(indexCapacity)
+    {
+        if (vertexStride == 0 || vertexCapacity == 0 || indexCapacity == 0)
+        {
+            throw std::runtime_error("Invalid geometry pool size!");
+        }
+        CreateGeometryPool();
+    }
+    GeometryPool::~GeometryPool()
+    {
+    }
+
+    void GeometryPool::CreateGeometryPool()
+    {
+        // 创建顶点缓冲区
+        mVertexBuffer = Buffer::New(mDevice, static_cast<size_t>(mVertexStride) * mVertexCapacity,
+                                    VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        //
+        // 创建索引缓冲区
+        mVertexIndexBuffer = Buffer::New(mDevice, sizeof(uint32_t) * static_cast<size_t>(mIndexCapacity),
+                                         VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+                                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        //
+    }
+    bool GeometryPool::Allocate(const void *vertexData, uint32_t vertexCount, const void *indexData, uint32_t indexCount, Mesh *mesh)
+    {
+        if (vertexCount > mVertexCapacity - mVertexCount || indexCount > mIndexCapacity - mIndexCount)
+        {
+            return false;
+        }
+        // 写入顶点与索引数据，传输命令记录到上传器的当前批次
+        if (!mVertexBuffer->WriteData(const_cast<void *>(vertexData), static_cast<VkDeviceSize>(mVertexCount) * mVertexStride, static_cast<VkDeviceSize>(vertexCount) * mVertexStride))
+        {
+            return false;
+        }
+        if (!mVertexIndexBuffer->WriteData(const_cast<void *>(indexData), sizeof(uint32_t) * static_cast<VkDeviceSize>(mIndexCount), sizeof(uint32_t) * static_cast<VkDeviceSize>(indexCount)))
+        {
+            return false;
+        }
+        mesh->FirstIndex = mIndexCount;
+        mesh->IndexCount = indexCount;
+        mesh->VertexOffset = static_cast<int32_t>(mVertexCount);
+        mVertexCount += vertexCount;
+        mIndexCount += indexCount;
+        return true;
+    }
+} // namespace vk
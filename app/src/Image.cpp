@@ -7,16 +7,18 @@ namespace vk
     {
         CreateImageBuffer(usage, properties);
     }
+    Image::Image(Device::Ptr device, uint32_t width, uint32_t height, VkFormat format, uint32_t mipLevels, VkImageUsageFlags usage, VkMemoryPropertyFlags properties)
+        : mDevice(device), mWidth(width), mHeight(height), mMipLevels(mipLevels), mFormat(format)
+    {
+        CreateImageBuffer(usage, properties);
+    }
     Image::~Image()
     {
         if (mImage != nullptr)
         {
             vkDestroyImage(mDevice->GetLogicalDevice(), mImage, nullptr);
         }
-        if (mImageMemory != nullptr)
-        {
-            vkFreeMemory(mDevice->GetLogicalDevice(), mImageMemory, nullptr);
-        }
+        mDevice->FreeMemory(&mImageMemory);
         if (mImageView != nullptr)
         {
             vkDestroyImageView(mDevice->GetLogicalDevice(), mImageView, nullptr);
@@ -34,37 +36,41 @@ namespace vk
         imageData.Name = GetFileName(filePath);
         return imageData;
     }
+    VkFormat Image::GetCompressedFormat(TextureCompressor::Format format)
+    {
+        switch (format)
+        {
+        case TextureCompressor::Format::BC1:
+            return VK_FORMAT_BC1_RGB_SRGB_BLOCK;
+        case TextureCompressor::Format::BC3:
+            return VK_FORMAT_BC3_SRGB_BLOCK;
+        case TextureCompressor::Format::RGBA8:
+            return VK_FORMAT_R8G8B8A8_SRGB;
+        }
+        return VK_FORMAT_UNDEFINED;
+    }
     void Image::CreateImageBuffer(VkImageUsageFlags usage, VkMemoryPropertyFlags properties)
     {
         // 获取长宽中的最大值，计算其可以被2整除多少次，然后计算不大于这个值的整数
-        mMipLevels = std::floor(std::log2(std::max(mWidth, mHeight))) + 1;
+        if (mMipLevels == 0)
+        {
+            mMipLevels = std::floor(std::log2(std::max(mWidth, mHeight))) + 1;
+        }
         mLayerCount = 1;
-        // 从CPU内存传输图像到GPU内存
-        {
-            if (!mDevice->CreateImage(mWidth, mHeight,
-                                      VK_FORMAT_R8G8B8A8_SRGB,
-                                      VK_IMAGE_TYPE_2D,
-                                      VK_SAMPLE_COUNT_1_BIT,
-                                      VK_IMAGE_TILING_OPTIMAL,
-                                      usage, properties,
-                                      mMipLevels, mLayerCount,
-                                      &mImage, &mImageMemory))
-            {
-                return;
-            }
-            // 布局转换为传输目标位
-            if (!mDevice->TransitionImageLayout(mImage, VK_IMAGE_ASPECT_COLOR_BIT, mMipLevels, mLayerCount, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL))
-            {
-                return;
-            }
-            // 为所有mip生成图像，这会转换图像内存布局为着色器只读位
-            if (!mDevice->GenerateMipmaps(mImage, VK_FORMAT_R8G8B8A8_SRGB, mWidth, mHeight, mMipLevels))
-            {
-                return;
-            }
+        // 创建图像，内容与布局在首次写入数据时初始化
+        if (!mDevice->CreateImage(mWidth, mHeight,
+                                  mFormat,
+                                  VK_IMAGE_TYPE_2D,
+                                  VK_SAMPLE_COUNT_1_BIT,
+                                  VK_IMAGE_TILING_OPTIMAL,
+                                  usage, properties,
+                                  mMipLevels, mLayerCount,
+                                  &mImage, &mImageMemory))
+        {
+            return;
         }
         // 创建纹理图像视图
-        mDevice->CreateImageView(mImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_ASPECT_COLOR_BIT, mMipLevels, mLayerCount, &mImageView);
+        mDevice->CreateImageView(mImage, mFormat, VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_ASPECT_COLOR_BIT, mMipLevels, mLayerCount, &mImageView);
     }
     bool Image::WriteImage(Image::Ptr image)
     {
@@ -74,8 +80,9 @@ namespace vk
         {
             return false;
         }
+        // 原有内容会被完整覆盖，从未定义布局转换
         if (!mDevice->TransitionImageLayout(mImage, VK_IMAGE_ASPECT_COLOR_BIT, mMipLevels, mLayerCount,
-                                            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL))
+                                            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL))
         {
             return false;
         }
@@ -91,7 +98,7 @@ namespace vk
             return false;
         }
         // 为所有mip重新生成图像，这会转换图像内存布局为着色器只读位
-        if (!mDevice->GenerateMipmaps(mImage, VK_FORMAT_R8G8B8A8_SRGB, mWidth, mHeight, mMipLevels))
+        if (!mDevice->GenerateMipmaps(mImage, mFormat, mWidth, mHeight, mMipLevels))
         {
             return false;
         }
@@ -99,16 +106,20 @@ namespace vk
     }
     bool Image::WriteBuffer(Buffer::Ptr buffer)
     {
-        // 布局转换为传输目标位
+        return WriteBufferRange(buffer->GetBuffer(), 0);
+    }
+    bool Image::WriteBufferRange(VkBuffer buffer, VkDeviceSize offset)
+    {
+        // 布局转换为传输目标位，原有内容会被完整覆盖
         if (!mDevice->TransitionImageLayout(mImage, VK_IMAGE_ASPECT_COLOR_BIT, mMipLevels, mLayerCount,
-                                            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL))
+                                            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL))
         {
             return false;
         }
         // 仅拷贝mip原图级别到目标对应mip等级，然后重新生成mip，从而降低数据传输量
-        mDevice->CopyBufferToImage(buffer->GetBuffer(), mImage, VK_IMAGE_ASPECT_COLOR_BIT, 0, mLayerCount, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mWidth, mHeight);
+        mDevice->CopyBufferToImage(buffer, offset, mImage, VK_IMAGE_ASPECT_COLOR_BIT, 0, mLayerCount, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mWidth, mHeight);
         // 为所有mip重新生成图像，这会转换图像内存布局为着色器只读位
-        if (!mDevice->GenerateMipmaps(mImage, VK_FORMAT_R8G8B8A8_SRGB, mWidth, mHeight, mMipLevels))
+        if (!mDevice->GenerateMipmaps(mImage, mFormat, mWidth, mHeight, mMipLevels))
         {
             return false;
         }
@@ -116,18 +127,47 @@ namespace vk
     }
     bool Image::WriteData(void *data)
     {
-        // 写入CPU内存
+        // 写入上传器的暂存内存
         uint64_t BufferSize = mWidth * mHeight * 4;
-        Buffer::Ptr TempBuffer = Buffer::New(mDevice, BufferSize,
-                                                 VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                                                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-        //
-        TempBuffer->WriteHostData(data);
-        // 从CPU内存传输图像到GPU内存
-        if (!WriteBuffer(TempBuffer))
+        Uploader::StagingRange StagingRange{};
+        if (!mDevice->GetUploader()->WriteStaging(data, BufferSize, &StagingRange))
+        {
+            return false;
+        }
+        // 在传输队列上拷贝原图级别，所有权转移到图形队列后生成mip，这会转换图像内存布局为着色器只读位
+        if (!mDevice->UploadImage(StagingRange.Buffer, StagingRange.Offset, mImage, VK_IMAGE_ASPECT_COLOR_BIT, mMipLevels, mLayerCount, mWidth, mHeight))
+        {
+            return false;
+        }
+        if (!mDevice->GenerateMipmaps(mImage, mFormat, mWidth, mHeight, mMipLevels))
         {
             return false;
         }
         return true;
     }
+    bool Image::WriteCompressedData(const uint8_t *data, const std::vector<TextureCompressor::MipLevel> &mipLevelList)
+    {
+        if (mipLevelList.size() != mMipLevels)
+        {
+            return false;
+        }
+        // 所有级别一次写入暂存内存，级别偏移满足块大小的对齐要求
+        const TextureCompressor::MipLevel &LastLevel = mipLevelList.back();
+        Uploader::StagingRange StagingRange{};
+        if (!mDevice->GetUploader()->WriteStaging(data, LastLevel.Offset + LastLevel.Size, &StagingRange))
+        {
+            return false;
+        }
+        std::vector<VkBufferImageCopy> BufferImageCopyList(mipLevelList.size());
+        for (size_t i = 0; i < mipLevelList.size(); i++)
+        {
+            BufferImageCopyList[i].bufferOffset = StagingRange.Offset + mipLevelList[i].Offset;
+            BufferImageCopyList[i].imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            BufferImageCopyList[i].imageSubresource.mipLevel = i;
+            BufferImageCopyList[i].imageSubresource.baseArrayLayer = 0;
+            BufferImageCopyList[i].imageSubresource.layerCount = mLayerCount;
+            BufferImageCopyList[i].imageExtent = {mipLevelList[i].Width, mipLevelList[i].Height, 1};
+        }
+        return mDevice->UploadImageLevels(StagingRange.Buffer, BufferImageCopyList, mImage, VK_IMAGE_ASPECT_COLOR_BIT, mMipLevels, mLayerCount);
+    }
 } // namespace vk
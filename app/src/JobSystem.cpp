@@ -0,0 +1,219 @@
+#include "vk/JobSystem.h"
+
+namespace vk
+{
+    // 当前线程所属的任务系统与队列
+    static thread_local JobSystem *tJobSystem = nullptr;
+    static thread_local uint32_t tWorkerIndex = 0;
+
+    JobSystem::JobSystem(uint32_t workerCount)
+    {
+        CreateWorker(workerCount);
+    }
+    JobSystem::~JobSystem()
+    {
+        // 执行完剩余任务后退出
+        {
+            std::lock_guard<std::mutex> Lock(mSleepMutex);
+            mIsStop = true;
+        }
+        mSleepCondition.notify_all();
+        for (auto &&i : mWorkerList)
+        {
+            i.join();
+        }
+    }
+
+    void JobSystem::CreateWorker(uint32_t workerCount)
+    {
+        for (uint32_t i = 0; i < workerCount + 1; i++)
+        {
+            mQueueList.push_back(std::make_unique<WorkerQueue>());
+        }
+        for (uint32_t i = 0; i < workerCount; i++)
+        {
+            mWorkerList.emplace_back(&JobSystem::WorkerLoop, this, i);
+        }
+    }
+    void JobSystem::WorkerLoop(uint32_t workerIndex)
+    {
+        tJobSystem = this;
+        tWorkerIndex = workerIndex;
+        while (true)
+        {
+            if (ExecuteOne(workerIndex))
+            {
+                continue;
+            }
+            std::unique_lock<std::mutex> Lock(mSleepMutex);
+            mSleepCondition.wait(Lock, [this]()
+                                 { return mIsStop || mPendingTaskCount > 0; });
+            if (mIsStop && mPendingTaskCount == 0)
+            {
+                return;
+            }
+        }
+    }
+    uint32_t JobSystem::GetQueueIndex()
+    {
+        // 非工作线程共用最后一个队列
+        return tJobSystem == this ? tWorkerIndex : mWorkerList.size();
+    }
+    void JobSystem::Push(Task task)
+    {
+        // 先计数再放入队列，取出任务的线程减一时计数不会下溢
+        mPendingTaskCount++;
+        WorkerQueue &Queue = *mQueueList[GetQueueIndex()];
+        {
+            std::lock_guard<std::mutex> Lock(Queue.Mutex);
+            Queue.TaskList.push_back(std::move(task));
+        }
+        // 加锁保证正在进入休眠的线程能收到通知
+        {
+            std::lock_guard<std::mutex> Lock(mSleepMutex);
+        }
+        mSleepCondition.notify_one();
+    }
+    bool JobSystem::ExecuteOne(uint32_t queueIndex)
+    {
+        Task CurrentTask;
+        bool IsFound = false;
+        // 优先从自己队列的队尾取出最近提交的任务
+        {
+            WorkerQueue &Queue = *mQueueList[queueIndex];
+            std::lock_guard<std::mutex> Lock(Queue.Mutex);
+            if (!Queue.TaskList.empty())
+            {
+                CurrentTask = std::move(Queue.TaskList.back());
+                Queue.TaskList.pop_back();
+                IsFound = true;
+            }
+        }
+        // 从其他队列的队首窃取最早提交的任务
+        for (size_t i = 1; !IsFound && i < mQueueList.size(); i++)
+        {
+            WorkerQueue &Queue = *mQueueList[(queueIndex + i) % mQueueList.size()];
+            std::lock_guard<std::mutex> Lock(Queue.Mutex);
+            if (!Queue.TaskList.empty())
+            {
+                CurrentTask = std::move(Queue.TaskList.front());
+                Queue.TaskList.pop_front();
+                IsFound = true;
+                mStealCount++;
+            }
+        }
+        if (!IsFound)
+        {
+            return false;
+        }
+        mPendingTaskCount--;
+        CurrentTask.Function();
+        mExecuteCount++;
+        Finish(CurrentTask.pCounter);
+        return true;
+    }
+    void JobSystem::Finish(Counter *counter)
+    {
+        if (counter == nullptr)
+        {
+            return;
+        }
+        std::vector<std::pair<Job, Counter *>> ContinuationList;
+        {
+            std::lock_guard<std::mutex> Lock(counter->mMutex);
+            if (counter->mValue.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                ContinuationList.swap(counter->mContinuationList);
+            }
+        }
+        for (auto &&i : ContinuationList)
+        {
+            Push({std::move(i.first), i.second});
+        }
+    }
+
+    void JobSystem::Run(Job job, Counter *counter)
+    {
+        if (counter != nullptr)
+        {
+            counter->mValue++;
+        }
+        Push({std::move(job), counter});
+    }
+    void JobSystem::Run(Counter *dependency, Job job, Counter *counter)
+    {
+        if (counter != nullptr)
+        {
+            counter->mValue++;
+        }
+        {
+            std::lock_guard<std::mutex> Lock(dependency->mMutex);
+            if (dependency->mValue > 0)
+            {
+                dependency->mContinuationList.push_back({std::move(job), counter});
+                return;
+            }
+        }
+        Push({std::move(job), counter});
+    }
+    void JobSystem::ParallelFor(uint32_t count, uint32_t groupSize, std::function<void(uint32_t, uint32_t)> job, Counter *counter)
+    {
+        groupSize = std::max(1u, groupSize);
+        for (uint32_t First = 0; First < count; First += groupSize)
+        {
+            uint32_t Last = std::min(First + groupSize, count);
+            Run([job, First, Last]()
+                { job(First, Last); },
+                counter);
+        }
+    }
+    void JobSystem::Wait(Counter *counter)
+    {
+        uint32_t QueueIndex = GetQueueIndex();
+        while (!counter->IsComplete())
+        {
+            if (!ExecuteOne(QueueIndex))
+            {
+                std::this_thread::yield();
+            }
+        }
+        // 等待最后一个任务释放计数器的锁，之后调用方可以安全销毁计数器
+        std::lock_guard<std::mutex> Lock(counter->mMutex);
+    }
+
+    void JobSystem::Benchmark(uint32_t jobCount)
+    {
+        uint32_t MaxThreadCount = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<uint32_t> ThreadCountList;
+        for (uint32_t i = 1; i < MaxThreadCount; i *= 2)
+        {
+            ThreadCountList.push_back(i);
+        }
+        ThreadCountList.push_back(MaxThreadCount);
+
+        std::vector<uint64_t> ResultList(jobCount);
+        for (auto &&ThreadCount : ThreadCountList)
+        {
+            // 主线程在等待时同样执行任务，因此工作线程数比总线程数少一
+            JobSystem System(ThreadCount - 1);
+            Counter JobCounter;
+            std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < jobCount; i++)
+            {
+                System.Run([&ResultList, i]()
+                           {
+                               uint64_t Value = i;
+                               for (uint32_t k = 0; k < 256; k++)
+                               {
+                                   Value = Value * 6364136223846793005ull + 1442695040888963407ull;
+                               }
+                               ResultList[i] = Value; },
+                           &JobCounter);
+            }
+            System.Wait(&JobCounter);
+            float Time = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::steady_clock::now() - StartTime).count();
+            printf("Threads: %u, Jobs: %u, Time: %.2fms, Throughput: %.0f jobs/ms, Steal: %llu\n",
+                   ThreadCount, jobCount, Time, jobCount / std::max(Time, 0.001f), (unsigned long long)System.GetStealCount());
+        }
+    }
+} // namespace vk
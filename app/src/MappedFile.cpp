@@ -0,0 +1,100 @@
+#include "vk/MappedFile.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace vk
+{
+    MappedFile::MappedFile(std::string filePath)
+    {
+        if (!MapFile(filePath))
+        {
+            mData = nullptr;
+            mSize = 0;
+        }
+    }
+    MappedFile::~MappedFile()
+    {
+#ifdef _WIN32
+        if (mData != nullptr)
+        {
+            UnmapViewOfFile(mData);
+        }
+        if (mMapping != nullptr)
+        {
+            CloseHandle(mMapping);
+        }
+        if (mFile != nullptr && mFile != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(mFile);
+        }
+#else
+        if (mData != nullptr)
+        {
+            munmap(const_cast<uint8_t *>(mData), mSize);
+        }
+        if (mFile != -1)
+        {
+            close(mFile);
+        }
+#endif
+    }
+
+    bool MappedFile::MapFile(std::string filePath)
+    {
+#ifdef _WIN32
+        mFile = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (mFile == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+        LARGE_INTEGER FileSize{};
+        if (!GetFileSizeEx(mFile, &FileSize) || FileSize.QuadPart == 0)
+        {
+            return false;
+        }
+        mMapping = CreateFileMappingA(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mMapping == nullptr)
+        {
+            return false;
+        }
+        mData = static_cast<const uint8_t *>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+        if (mData == nullptr)
+        {
+            return false;
+        }
+        mSize = static_cast<size_t>(FileSize.QuadPart);
+#else
+        mFile = open(filePath.c_str(), O_RDONLY);
+        if (mFile == -1)
+        {
+            return false;
+        }
+        struct stat FileStat{};
+        if (fstat(mFile, &FileStat) != 0 || FileStat.st_size == 0)
+        {
+            return false;
+        }
+        void *Data = mmap(nullptr, FileStat.st_size, PROT_READ, MAP_PRIVATE, mFile, 0);
+        if (Data == MAP_FAILED)
+        {
+            return false;
+        }
+        mData = static_cast<const uint8_t *>(Data);
+        mSize = static_cast<size_t>(FileStat.st_size);
+#endif
+        return true;
+    }
+} // namespace vk
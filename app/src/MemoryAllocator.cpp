@@ -0,0 +1,327 @@
+#include "vk/MemoryAllocator.h"
+
+namespace vk
+{
+    // 按2的幂对齐
+    static VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+    // 判断前一个资源的末尾与后一个资源的起始是否位于同一页
+    static bool IsOnSamePage(VkDeviceSize endOffset, VkDeviceSize startOffset, VkDeviceSize pageSize)
+    {
+        return (endOffset & ~(pageSize - 1)) == (startOffset & ~(pageSize - 1));
+    }
+    // 线性资源与最优排列资源不能共享同一页
+    static bool IsTypeConflict(MemoryAllocator::ResourceType a, MemoryAllocator::ResourceType b)
+    {
+        if (a == MemoryAllocator::ResourceType::Free || b == MemoryAllocator::ResourceType::Free)
+        {
+            return false;
+        }
+        return a != b;
+    }
+
+    MemoryAllocator::MemoryAllocator(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, VkDeviceSize blockSize)
+        : mLogicalDevice(logicalDevice), mBlockSize(blockSize)
+    {
+        vkGetPhysicalDeviceMemoryProperties(physicalDevice, &mMemoryProperties);
+        VkPhysicalDeviceProperties PhysicalDeviceProperties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &PhysicalDeviceProperties);
+        mBufferImageGranularity = std::max<VkDeviceSize>(PhysicalDeviceProperties.limits.bufferImageGranularity, 1);
+        mMaxMemoryAllocationCount = PhysicalDeviceProperties.limits.maxMemoryAllocationCount;
+        mBlockList.resize(mMemoryProperties.memoryTypeCount);
+    }
+    MemoryAllocator::~MemoryAllocator()
+    {
+        for (auto &&i : mBlockList)
+        {
+            for (auto &&j : i)
+            {
+                if (j->MappedData != nullptr)
+                {
+                    vkUnmapMemory(mLogicalDevice, j->Memory);
+                }
+                vkFreeMemory(mLogicalDevice, j->Memory, nullptr);
+            }
+        }
+    }
+
+    VkDeviceSize MemoryAllocator::GetPreferredBlockSize(uint32_t memoryTypeIndex)
+    {
+        // 小堆（例如256MB的可映射显存）使用更小的内存块，避免一次占满
+        VkDeviceSize HeapSize = mMemoryProperties.memoryHeaps[mMemoryProperties.memoryTypes[memoryTypeIndex].heapIndex].size;
+        if (HeapSize <= 1024ull * 1024 * 1024)
+        {
+            return std::min(mBlockSize, AlignUp(HeapSize / 8, 32));
+        }
+        return mBlockSize;
+    }
+    MemoryAllocator::Block *MemoryAllocator::CreateBlock(uint32_t memoryTypeIndex, VkDeviceSize size, bool isDedicated)
+    {
+        VkMemoryAllocateInfo MemoryAllocateInfo{};
+        MemoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        MemoryAllocateInfo.allocationSize = size;
+        MemoryAllocateInfo.memoryTypeIndex = memoryTypeIndex;
+        VkDeviceMemory Memory = nullptr;
+        if (vkAllocateMemory(mLogicalDevice, &MemoryAllocateInfo, nullptr, &Memory) != VK_SUCCESS)
+        {
+            return nullptr;
+        }
+
+        std::unique_ptr<Block> NewBlock = std::make_unique<Block>();
+        NewBlock->Memory = Memory;
+        NewBlock->Size = size;
+        NewBlock->MemoryTypeIndex = memoryTypeIndex;
+        NewBlock->IsDedicated = isDedicated;
+        // 主机可见内存整块常驻映射，同一块内存不能被重复映射
+        if (mMemoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+        {
+            if (vkMapMemory(mLogicalDevice, Memory, 0, VK_WHOLE_SIZE, 0, &NewBlock->MappedData) != VK_SUCCESS)
+            {
+                vkFreeMemory(mLogicalDevice, Memory, nullptr);
+                return nullptr;
+            }
+        }
+        // 初始为一整段空闲区段
+        NewBlock->ChunkList[0] = {size, ResourceType::Free};
+        InsertFreeChunk(NewBlock.get(), 0, size);
+
+        Block *pBlock = NewBlock.get();
+        mBlockList[memoryTypeIndex].push_back(std::move(NewBlock));
+        return pBlock;
+    }
+    void MemoryAllocator::DestroyBlock(Block *block)
+    {
+        if (block->MappedData != nullptr)
+        {
+            vkUnmapMemory(mLogicalDevice, block->Memory);
+        }
+        vkFreeMemory(mLogicalDevice, block->Memory, nullptr);
+        std::vector<std::unique_ptr<Block>> &TypeBlockList = mBlockList[block->MemoryTypeIndex];
+        for (auto i = TypeBlockList.begin(); i != TypeBlockList.end(); i++)
+        {
+            if (i->get() == block)
+            {
+                TypeBlockList.erase(i);
+                break;
+            }
+        }
+    }
+    void MemoryAllocator::InsertFreeChunk(Block *block, VkDeviceSize offset, VkDeviceSize size)
+    {
+        block->FreeList.emplace(size, offset);
+    }
+    void MemoryAllocator::EraseFreeChunk(Block *block, VkDeviceSize offset, VkDeviceSize size)
+    {
+        auto Range = block->FreeList.equal_range(size);
+        for (auto i = Range.first; i != Range.second; i++)
+        {
+            if (i->second == offset)
+            {
+                block->FreeList.erase(i);
+                return;
+            }
+        }
+    }
+    bool MemoryAllocator::AllocateFromBlock(Block *block, VkMemoryRequirements memoryRequirements, ResourceType type, Allocation *allocation)
+    {
+        if (block->Size - block->UsedBytes < memoryRequirements.size)
+        {
+            return false;
+        }
+        VkDeviceSize Alignment = std::max<VkDeviceSize>(memoryRequirements.alignment, 1);
+        // 最佳适配：从不小于需求的最小空闲区段开始尝试
+        for (auto FreeIter = block->FreeList.lower_bound(memoryRequirements.size); FreeIter != block->FreeList.end(); FreeIter++)
+        {
+            VkDeviceSize FreeSize = FreeIter->first;
+            VkDeviceSize FreeOffset = FreeIter->second;
+            auto ChunkIter = block->ChunkList.find(FreeOffset);
+            VkDeviceSize Offset = AlignUp(FreeOffset, Alignment);
+
+            // 与前一个区段位于同一页且排列方式冲突时，按粒度对齐
+            if (mBufferImageGranularity > 1 && ChunkIter != block->ChunkList.begin())
+            {
+                auto PrevIter = std::prev(ChunkIter);
+                if (IsTypeConflict(PrevIter->second.Type, type) &&
+                    IsOnSamePage(PrevIter->first + PrevIter->second.Size - 1, Offset, mBufferImageGranularity))
+                {
+                    Offset = AlignUp(Offset, mBufferImageGranularity);
+                }
+            }
+            if (Offset + memoryRequirements.size > FreeOffset + FreeSize)
+            {
+                continue;
+            }
+            // 与后一个区段位于同一页且排列方式冲突时，跳过该空闲区段
+            if (mBufferImageGranularity > 1)
+            {
+                auto NextIter = std::next(ChunkIter);
+                if (NextIter != block->ChunkList.end() && IsTypeConflict(NextIter->second.Type, type) &&
+                    IsOnSamePage(Offset + memoryRequirements.size - 1, NextIter->first, mBufferImageGranularity))
+                {
+                    continue;
+                }
+            }
+
+            // 拆分空闲区段为：前部对齐空隙、已用区段、尾部剩余
+            VkDeviceSize FreeEnd = FreeOffset + FreeSize;
+            VkDeviceSize UsedEnd = Offset + memoryRequirements.size;
+            block->FreeList.erase(FreeIter);
+            block->ChunkList.erase(ChunkIter);
+            if (Offset > FreeOffset)
+            {
+                block->ChunkList[FreeOffset] = {Offset - FreeOffset, ResourceType::Free};
+                InsertFreeChunk(block, FreeOffset, Offset - FreeOffset);
+            }
+            block->ChunkList[Offset] = {memoryRequirements.size, type};
+            if (UsedEnd < FreeEnd)
+            {
+                block->ChunkList[UsedEnd] = {FreeEnd - UsedEnd, ResourceType::Free};
+                InsertFreeChunk(block, UsedEnd, FreeEnd - UsedEnd);
+            }
+            block->UsedBytes += memoryRequirements.size;
+            block->AllocationCount++;
+
+            allocation->Memory = block->Memory;
+            allocation->Offset = Offset;
+            allocation->Size = memoryRequirements.size;
+            allocation->MappedData = block->MappedData != nullptr ? static_cast<char *>(block->MappedData) + Offset : nullptr;
+            allocation->pBlock = block;
+            return true;
+        }
+        return false;
+    }
+
+    bool MemoryAllocator::Allocate(VkMemoryRequirements memoryRequirements, uint32_t memoryTypeIndex, ResourceType type, Allocation *allocation)
+    {
+        std::lock_guard<std::mutex> Lock(mMutex);
+        if (memoryTypeIndex >= mBlockList.size())
+        {
+            return false;
+        }
+
+        // 大于内存块一半的资源使用独占内存块
+        VkDeviceSize PreferredBlockSize = GetPreferredBlockSize(memoryTypeIndex);
+        if (memoryRequirements.size > PreferredBlockSize / 2)
+        {
+            Block *DedicatedBlock = CreateBlock(memoryTypeIndex, memoryRequirements.size, true);
+            if (DedicatedBlock == nullptr)
+            {
+                return false;
+            }
+            return AllocateFromBlock(DedicatedBlock, memoryRequirements, type, allocation);
+        }
+
+        // 从已有内存块中分配
+        for (auto &&i : mBlockList[memoryTypeIndex])
+        {
+            if (!i->IsDedicated && AllocateFromBlock(i.get(), memoryRequirements, type, allocation))
+            {
+                return true;
+            }
+        }
+
+        // 申请新的内存块，内存不足时逐步减半
+        for (VkDeviceSize BlockSize = PreferredBlockSize; BlockSize >= memoryRequirements.size; BlockSize /= 2)
+        {
+            Block *NewBlock = CreateBlock(memoryTypeIndex, BlockSize, false);
+            if (NewBlock != nullptr)
+            {
+                return AllocateFromBlock(NewBlock, memoryRequirements, type, allocation);
+            }
+        }
+        return false;
+    }
+    void MemoryAllocator::Free(Allocation *allocation)
+    {
+        if (allocation->pBlock == nullptr)
+        {
+            return;
+        }
+        std::lock_guard<std::mutex> Lock(mMutex);
+        Block *pBlock = allocation->pBlock;
+        auto ChunkIter = pBlock->ChunkList.find(allocation->Offset);
+        if (ChunkIter == pBlock->ChunkList.end() || ChunkIter->second.Type == ResourceType::Free)
+        {
+            return;
+        }
+        VkDeviceSize Offset = ChunkIter->first;
+        VkDeviceSize Size = ChunkIter->second.Size;
+        pBlock->UsedBytes -= Size;
+        pBlock->AllocationCount--;
+
+        // 与后一个空闲区段合并
+        auto NextIter = std::next(ChunkIter);
+        if (NextIter != pBlock->ChunkList.end() && NextIter->second.Type == ResourceType::Free)
+        {
+            EraseFreeChunk(pBlock, NextIter->first, NextIter->second.Size);
+            Size += NextIter->second.Size;
+            pBlock->ChunkList.erase(NextIter);
+        }
+        // 与前一个空闲区段合并
+        if (ChunkIter != pBlock->ChunkList.begin())
+        {
+            auto PrevIter = std::prev(ChunkIter);
+            if (PrevIter->second.Type == ResourceType::Free)
+            {
+                EraseFreeChunk(pBlock, PrevIter->first, PrevIter->second.Size);
+                Offset = PrevIter->first;
+                Size += PrevIter->second.Size;
+                pBlock->ChunkList.erase(ChunkIter);
+                ChunkIter = PrevIter;
+            }
+        }
+        ChunkIter->second = {Size, ResourceType::Free};
+        InsertFreeChunk(pBlock, Offset, Size);
+        *allocation = {};
+
+        // 释放空闲内存块，每种内存类型保留一个空块以避免反复申请
+        if (pBlock->AllocationCount == 0)
+        {
+            bool IsHaveOtherEmptyBlock = false;
+            for (auto &&i : mBlockList[pBlock->MemoryTypeIndex])
+            {
+                if (i.get() != pBlock && !i->IsDedicated && i->AllocationCount == 0)
+                {
+                    IsHaveOtherEmptyBlock = true;
+                    break;
+                }
+            }
+            if (pBlock->IsDedicated || IsHaveOtherEmptyBlock)
+            {
+                DestroyBlock(pBlock);
+            }
+        }
+    }
+    MemoryAllocator::Statistics MemoryAllocator::GetStatistics()
+    {
+        std::lock_guard<std::mutex> Lock(mMutex);
+        Statistics Stats{};
+        for (auto &&i : mBlockList)
+        {
+            for (auto &&j : i)
+            {
+                Stats.BlockCount++;
+                if (j->IsDedicated)
+                {
+                    Stats.DedicatedBlockCount++;
+                }
+                Stats.AllocationCount += j->AllocationCount;
+                Stats.BlockBytes += j->Size;
+                Stats.UsedBytes += j->UsedBytes;
+                for (auto &&k : j->FreeList)
+                {
+                    Stats.FreeRangeCount++;
+                    Stats.FreeBytes += k.first;
+                    Stats.LargestFreeRange = std::max(Stats.LargestFreeRange, k.first);
+                }
+            }
+        }
+        if (Stats.FreeBytes > 0)
+        {
+            Stats.Fragmentation = 1.0f - static_cast<float>(Stats.LargestFreeRange) / static_cast<float>(Stats.FreeBytes);
+        }
+        return Stats;
+    }
+} // namespace vk
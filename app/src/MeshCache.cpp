@@ -0,0 +1,49 @@
+#include "vk/MeshCache.h"
+
+namespace vk
+{
+    bool MeshCache::Validate(MappedFile::Ptr file, uint64_t sourceHash, uint32_t importFlags, uint32_t vertexStride)
+    {
+        if (file->GetData() == nullptr || file->GetSize() < sizeof(Header))
+        {
+            return false;
+        }
+        const Header *FileHeader = reinterpret_cast<const Header *>(file->GetData());
+        if (FileHeader->Magic != mMagic || FileHeader->Version != mVersion || FileHeader->SourceHash != sourceHash ||
+            FileHeader->ImportFlags != importFlags || FileHeader->VertexStride != vertexStride)
+        {
+            return false;
+        }
+        // 网格表与数据块不能超出文件
+        uint64_t TableEnd = sizeof(Header) + static_cast<uint64_t>(sizeof(MeshEntry)) * FileHeader->MeshCount;
+        if (TableEnd > file->GetSize())
+        {
+            return false;
+        }
+        const MeshEntry *MeshTable = reinterpret_cast<const MeshEntry *>(file->GetData() + sizeof(Header));
+        for (uint32_t i = 0; i < FileHeader->MeshCount; i++)
+        {
+            if (MeshTable[i].VertexOffset < TableEnd || MeshTable[i].VertexOffset % mBlobAlignment != 0 || MeshTable[i].VertexOffset > file->GetSize() ||
+                static_cast<uint64_t>(vertexStride) * MeshTable[i].VertexCount > file->GetSize() - MeshTable[i].VertexOffset)
+            {
+                return false;
+            }
+            if (MeshTable[i].IndexOffset < TableEnd || MeshTable[i].IndexOffset % mBlobAlignment != 0 || MeshTable[i].IndexOffset > file->GetSize() ||
+                sizeof(uint32_t) * static_cast<uint64_t>(MeshTable[i].IndexCount) > file->GetSize() - MeshTable[i].IndexOffset)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    uint64_t MeshCache::HashFile(std::string filePath)
+    {
+        MappedFile::Ptr File = MappedFile::New(filePath);
+        if (File->GetData() == nullptr)
+        {
+            return 0;
+        }
+        return ContentHash::Hash(File->GetData(), File->GetSize());
+    }
+} // namespace vk
@@ -1,5 +1,10 @@
 #include "vk/ModelBuffer.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VK_MODEL_BUFFER_SSE
+#endif
+
 namespace vk
 {
     ModelBuffer::ModelBuffer(Device::Ptr device, void *vertexData, uint64_t vertexDataSize, void *indexData, uint64_t indexDataSize, uint32_t vertexIndexCount)
@@ -26,4 +31,108 @@ namespace vk
         //
         mVertexIndexBuffer->WriteData(indexData);
     }
+
+    void ModelBuffer::FlattenNode(const aiScene *scene, aiNode *node, const glm::mat4 &parentTransform, std::vector<MeshNode> *meshNodeList)
+    {
+        glm::mat4 Transform = parentTransform * ToMat4(node->mTransformation);
+        if (scene->HasMeshes())
+        {
+            for (size_t i = 0; i < node->mNumMeshes; i++)
+            {
+                meshNodeList->push_back({scene->mMeshes[node->mMeshes[i]], Transform});
+            }
+        }
+        for (size_t i = 0; i < node->mNumChildren; i++)
+        {
+            FlattenNode(scene, node->mChildren[i], Transform, meshNodeList);
+        }
+    }
+    ModelBuffer::BoundingVolume ModelBuffer::ComputeBoundingVolume(const float *positionData, size_t stride, size_t count)
+    {
+        BoundingVolume Volume{};
+        if (positionData == nullptr || count == 0)
+        {
+            return Volume;
+        }
+        const uint8_t *Data = reinterpret_cast<const uint8_t *>(positionData);
+        glm::vec3 Min(positionData[0], positionData[1], positionData[2]);
+        glm::vec3 Max = Min;
+        size_t Begin = 0;
+#if defined(VK_MODEL_BUFFER_SSE)
+        // 一次读取4个float，第4个属于下一个位置或顶点的其余分量，结果中忽略，最后一个位置逐分量处理避免越界
+        // 初始值取第一个位置的xyz，只有一个位置时不做向量读取
+        if (count > 1)
+        {
+            __m128 MinLane = _mm_setr_ps(Min.x, Min.y, Min.z, Min.x);
+            __m128 MaxLane = MinLane;
+            for (; Begin + 1 < count; Begin++)
+            {
+                __m128 Position = _mm_loadu_ps(reinterpret_cast<const float *>(Data + Begin * stride));
+                MinLane = _mm_min_ps(MinLane, Position);
+                MaxLane = _mm_max_ps(MaxLane, Position);
+            }
+            alignas(16) float MinList[4];
+            alignas(16) float MaxList[4];
+            _mm_store_ps(MinList, MinLane);
+            _mm_store_ps(MaxList, MaxLane);
+            Min = glm::vec3(MinList[0], MinList[1], MinList[2]);
+            Max = glm::vec3(MaxList[0], MaxList[1], MaxList[2]);
+        }
+#endif
+        for (size_t i = Begin; i < count; i++)
+        {
+            const float *Position = reinterpret_cast<const float *>(Data + i * stride);
+            Min = glm::min(Min, glm::vec3(Position[0], Position[1], Position[2]));
+            Max = glm::max(Max, glm::vec3(Position[0], Position[1], Position[2]));
+        }
+        Volume.Min = Min;
+        Volume.Max = Max;
+        // 包围盒中心作为球心，半径为到最远位置的距离
+        glm::vec3 Center = (Min + Max) * 0.5f;
+        float RadiusSquared = 0.0f;
+        for (size_t i = 0; i < count; i++)
+        {
+            const float *Position = reinterpret_cast<const float *>(Data + i * stride);
+            glm::vec3 Offset = glm::vec3(Position[0], Position[1], Position[2]) - Center;
+            RadiusSquared = std::max(RadiusSquared, glm::dot(Offset, Offset));
+        }
+        Volume.Sphere = glm::vec4(Center, std::sqrt(RadiusSquared));
+        return Volume;
+    }
+    ModelBuffer::BoundingVolume ModelBuffer::TransformBoundingVolume(const BoundingVolume &boundingVolume, const glm::mat4 &transform)
+    {
+        BoundingVolume Volume{};
+        // 中心直接变换，半长按矩阵元素的绝对值变换
+        glm::vec3 Center = (boundingVolume.Min + boundingVolume.Max) * 0.5f;
+        glm::vec3 Extent = (boundingVolume.Max - boundingVolume.Min) * 0.5f;
+        glm::vec3 NewCenter = glm::vec3(transform * glm::vec4(Center, 1.0f));
+        glm::vec3 NewExtent(0.0f);
+        float MaxScale = 0.0f;
+        for (int i = 0; i < 3; i++)
+        {
+            for (int j = 0; j < 3; j++)
+            {
+                NewExtent[j] += std::abs(transform[i][j]) * Extent[i];
+            }
+            MaxScale = std::max(MaxScale, glm::length(glm::vec3(transform[i])));
+        }
+        Volume.Min = NewCenter - NewExtent;
+        Volume.Max = NewCenter + NewExtent;
+        // 包围球半径按最大缩放放大
+        Volume.Sphere = glm::vec4(glm::vec3(transform * glm::vec4(glm::vec3(boundingVolume.Sphere), 1.0f)), boundingVolume.Sphere.w * MaxScale);
+        return Volume;
+    }
+    glm::mat4 ModelBuffer::ToMat4(const aiMatrix4x4 &matrix)
+    {
+        // Assimp按行存储，glm按列存储
+        glm::mat4 Mat{};
+        for (int i = 0; i < 4; i++)
+        {
+            for (int j = 0; j < 4; j++)
+            {
+                Mat[i][j] = matrix[j][i];
+            }
+        }
+        return Mat;
+    }
 } // namespace vk
@@ -3,7 +3,7 @@
 namespace vk
 {
     Pipeline::Pipeline(Device::Ptr device, DescriptorSetLayout::Ptr descriptorSet, PipelineInfo info)
-        : mDevice(device)
+        : mDevice(device), mIsTranslucent(info.IsTranslucent)
     {
         CreatePipeline(descriptorSet, info);
     }
@@ -29,26 +29,17 @@ namespace vk
             ShaderStageCreateInfoList.push_back(ShaderStageCreateInfo);
         }
 
-        // 视口
-        VkExtent2D Extent = mDevice->GetSwapchainImageExtent();
-        VkViewport Viewport{};
-        Viewport.x = 0.0f;
-        Viewport.y = 0.0f;
-        Viewport.width = Extent.width;
-        Viewport.height = Extent.height;
-        Viewport.minDepth = 0.0f;
-        Viewport.maxDepth = 1.0f;
-        // 剪裁
-        VkRect2D Scissor{};
-        Scissor.offset = {0, 0};
-        Scissor.extent = Extent;
-        // 视口与剪裁
+        // 视口与剪裁，使用动态状态在录制命令时设置，窗口尺寸变化时无需重建管线
         VkPipelineViewportStateCreateInfo ViewportStateCreateInfo{};
         ViewportStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
         ViewportStateCreateInfo.viewportCount = 1;
-        ViewportStateCreateInfo.pViewports = &Viewport;
         ViewportStateCreateInfo.scissorCount = 1;
-        ViewportStateCreateInfo.pScissors = &Scissor;
+        // 动态状态
+        std::array<VkDynamicState, 2> DynamicStateList = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+        VkPipelineDynamicStateCreateInfo DynamicStateCreateInfo{};
+        DynamicStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+        DynamicStateCreateInfo.dynamicStateCount = DynamicStateList.size();
+        DynamicStateCreateInfo.pDynamicStates = DynamicStateList.data();
 
         // 光栅化
         VkPipelineRasterizationStateCreateInfo RasterizationStateCreateInfo{};
@@ -123,6 +114,10 @@ namespace vk
         GraphicsPipelineCreateInfo.pInputAssemblyState = &InputAssemblyStateCreateInfo;
         GraphicsPipelineCreateInfo.pDepthStencilState = &DepthStencilStateCreateInfo;
         GraphicsPipelineCreateInfo.pColorBlendState = &ColorBlendStateCreateInfo;
-        vkCreateGraphicsPipelines(mDevice->GetLogicalDevice(), nullptr, 1, &GraphicsPipelineCreateInfo, nullptr, &mPipeline);
+        GraphicsPipelineCreateInfo.pDynamicState = &DynamicStateCreateInfo;
+        if (vkCreateGraphicsPipelines(mDevice->GetLogicalDevice(), mDevice->GetPipelineCache(), 1, &GraphicsPipelineCreateInfo, nullptr, &mPipeline) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to create graphics pipeline!");
+        }
     }
 } // namespace vk
@@ -0,0 +1,41 @@
+#include "vk/PipelineBuilder.h"
+
+namespace vk
+{
+    PipelineBuilder::PipelineBuilder(Device::Ptr device, JobSystem::Ptr jobSystem)
+        : mDevice(device), mJobSystem(jobSystem)
+    {
+    }
+    PipelineBuilder::~PipelineBuilder()
+    {
+        // 任务引用了构建器自身，需要等待全部完成
+        mJobSystem->Wait(&mBuildCounter);
+    }
+
+    std::future<Pipeline::Ptr> PipelineBuilder::Build(std::string name, DescriptorSetLayout::Ptr descriptorSet, Pipeline::PipelineInfo info)
+    {
+        // 任务持有着色器模块与描述符布局，编译完成前不会被释放
+        auto Task = std::make_shared<std::packaged_task<Pipeline::Ptr()>>(
+            [this, name, descriptorSet, info]()
+            {
+                std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+                Pipeline::Ptr NewPipeline = Pipeline::New(mDevice, descriptorSet, info);
+                float BuildTime = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::steady_clock::now() - StartTime).count();
+                {
+                    std::lock_guard<std::mutex> Lock(mRecordMutex);
+                    mBuildRecordList.push_back({name, BuildTime});
+                }
+                return NewPipeline;
+            });
+        std::future<Pipeline::Ptr> Result = Task->get_future();
+        mJobSystem->Run([Task]()
+                        { (*Task)(); },
+                        &mBuildCounter);
+        return Result;
+    }
+    std::vector<PipelineBuilder::BuildRecord> PipelineBuilder::GetBuildRecordList()
+    {
+        std::lock_guard<std::mutex> Lock(mRecordMutex);
+        return mBuildRecordList;
+    }
+} // namespace vk
@@ -2,14 +2,30 @@
 
 namespace vk
 {
-    Renderer::Renderer(Device::Ptr device)
-        : mDevice(device)
+    Renderer::Renderer(Device::Ptr device, JobSystem::Ptr jobSystem)
+        : mDevice(device), mJobSystem(jobSystem)
     {
         AllocateCommandBuffer();
         CreateSyncObjects();
+        CreateImageSyncObjects();
+        CreateThreadCommand();
     }
     Renderer::~Renderer()
     {
+        // 录制任务命令池
+        for (auto &&i : mThreadCommandList)
+        {
+            for (auto &&j : i)
+            {
+                vkDestroyCommandPool(mDevice->GetLogicalDevice(), j.CommandPool, nullptr);
+            }
+        }
+        DestroyImageSyncObjects();
+        // 命令缓冲区
+        if (!mCommandBufferList.empty())
+        {
+            vkFreeCommandBuffers(mDevice->GetLogicalDevice(), mDevice->GetCommandPool(), mCommandBufferList.size(), mCommandBufferList.data());
+        }
         // 围栏
         for (auto &&i : mFenceList)
         {
@@ -26,18 +42,11 @@ namespace vk
                 vkDestroySemaphore(mDevice->GetLogicalDevice(), i, nullptr);
             }
         }
-        for (auto &&i : mSubmitPresentList)
-        {
-            if (i != nullptr)
-            {
-                vkDestroySemaphore(mDevice->GetLogicalDevice(), i, nullptr);
-            }
-        }
     }
 
     void Renderer::AllocateCommandBuffer()
     {
-        mCommandBufferList.resize(mDevice->GetSwapchainImageCount());
+        mCommandBufferList.resize(mDevice->GetFrameInFlightCount());
         VkCommandBufferAllocateInfo CommandBufferAllocateInfo{};
         CommandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
         CommandBufferAllocateInfo.commandPool = mDevice->GetCommandPool();
@@ -50,9 +59,8 @@ namespace vk
     }
     void Renderer::CreateSyncObjects()
     {
-        mStartRenderList.resize(mDevice->GetSwapchainImageCount());
-        mSubmitPresentList.resize(mDevice->GetSwapchainImageCount());
-        mFenceList.resize(mDevice->GetSwapchainImageCount());
+        mStartRenderList.resize(mDevice->GetFrameInFlightCount());
+        mFenceList.resize(mDevice->GetFrameInFlightCount());
 
         VkSemaphoreCreateInfo SemaphoreCreateInfo{};
         SemaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
@@ -61,139 +69,580 @@ namespace vk
         FenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
         FenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT; // 初始点亮
 
-        for (size_t i = 0; i < mDevice->GetSwapchainImageCount(); i++)
+        for (size_t i = 0; i < mDevice->GetFrameInFlightCount(); i++)
         {
             if (vkCreateSemaphore(mDevice->GetLogicalDevice(), &SemaphoreCreateInfo, nullptr, &mStartRenderList[i]) != VK_SUCCESS)
             {
                 throw std::runtime_error("Failed to create start rendering signal!");
             }
-            if (vkCreateSemaphore(mDevice->GetLogicalDevice(), &SemaphoreCreateInfo, nullptr, &mSubmitPresentList[i]) != VK_SUCCESS)
-            {
-                throw std::runtime_error("Failed to create start rendering signal!");
-            }
             if (vkCreateFence(mDevice->GetLogicalDevice(), &FenceCreateInfo, nullptr, &mFenceList[i]) != VK_SUCCESS)
             {
                 throw std::runtime_error("Failed to create fence!");
             }
         }
     }
+    void Renderer::CreateThreadCommand()
+    {
+        // 每帧每个录制任务独占一个命令池，最后一个用于主线程录制ImGui
+        mThreadCommandList.resize(mDevice->GetFrameInFlightCount());
+        for (auto &&i : mThreadCommandList)
+        {
+            i.resize(GetRecordThreadCount() + 1);
+            for (auto &&j : i)
+            {
+                VkCommandPoolCreateInfo CommandPoolCreateInfo{};
+                CommandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+                CommandPoolCreateInfo.queueFamilyIndex = mDevice->GetGraphicsQueueFamilyIndex();
+                CommandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+                if (vkCreateCommandPool(mDevice->GetLogicalDevice(), &CommandPoolCreateInfo, nullptr, &j.CommandPool) != VK_SUCCESS)
+                {
+                    throw std::runtime_error("Failed to create record thread command pool!");
+                }
+                VkCommandBufferAllocateInfo CommandBufferAllocateInfo{};
+                CommandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+                CommandBufferAllocateInfo.commandPool = j.CommandPool;
+                CommandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+                CommandBufferAllocateInfo.commandBufferCount = 1;
+                if (vkAllocateCommandBuffers(mDevice->GetLogicalDevice(), &CommandBufferAllocateInfo, &j.CommandBuffer) != VK_SUCCESS)
+                {
+                    throw std::runtime_error("Failed to allocate secondary command buffer!");
+                }
+            }
+        }
+    }
+    void Renderer::CreateImageSyncObjects()
+    {
+        // 呈现信号按交换链图像创建，图像被再次获取时上一次呈现必然已经消耗该信号
+        mSubmitPresentList.resize(mDevice->GetSwapchainImageCount());
+        mImageFenceList.assign(mDevice->GetSwapchainImageCount(), nullptr);
+
+        VkSemaphoreCreateInfo SemaphoreCreateInfo{};
+        SemaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        for (auto &&i : mSubmitPresentList)
+        {
+            if (vkCreateSemaphore(mDevice->GetLogicalDevice(), &SemaphoreCreateInfo, nullptr, &i) != VK_SUCCESS)
+            {
+                throw std::runtime_error("Failed to create submit present signal!");
+            }
+        }
+    }
+    void Renderer::DestroyImageSyncObjects()
+    {
+        for (auto &&i : mSubmitPresentList)
+        {
+            if (i != nullptr)
+            {
+                vkDestroySemaphore(mDevice->GetLogicalDevice(), i, nullptr);
+            }
+        }
+        mSubmitPresentList.clear();
+        mImageFenceList.clear();
+    }
+    bool Renderer::RecreateSwapchain()
+    {
+        if (!mDevice->RecreateSwapchain())
+        {
+            return false;
+        }
+        mIsSwapchainDirty = false;
+        // 重建时设备已空闲，各帧资源与交换链图像数量无关，只需重建按图像创建的同步对象
+        DestroyImageSyncObjects();
+        CreateImageSyncObjects();
+        return true;
+    }
     void Renderer::Render(std::function<void(uint32_t)> drawOperations)
     {
-        // 等待同步信号
+        // 交换链过期时先重建，窗口最小化时跳过本帧
+        if (mIsSwapchainDirty && !RecreateSwapchain())
+        {
+            return;
+        }
+        // 获取 -> 录制 -> 提交 -> 呈现
+        WaitFrame();
+        uint32_t FrameIndex = 0;
+        if (!AcquireFrame(&FrameIndex))
+        {
+            return;
+        }
+        RecordFrame(FrameIndex, drawOperations);
+        SubmitFrame(FrameIndex);
+        PresentFrame(FrameIndex);
+        // 关闭重叠时等待本帧执行完毕，下一帧录制时GPU处于空闲
+        if (!mIsFrameOverlap)
+        {
+            std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+            vkWaitForFences(mDevice->GetLogicalDevice(), 1, &mFenceList[mCurrentIndex], VK_TRUE, UINT64_MAX);
+            mFenceWaitTime += std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::steady_clock::now() - StartTime).count();
+        }
+        mCurrentIndex = (mCurrentIndex + 1) % mDevice->GetFrameInFlightCount();
+    }
+    void Renderer::WaitFrame()
+    {
+        // 等待本帧资源上一次的使用完成，开启重叠时GPU仍可执行其余帧
+        std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
         vkWaitForFences(mDevice->GetLogicalDevice(), 1, &mFenceList[mCurrentIndex], VK_TRUE, UINT64_MAX);
-        // 重置同步信号状态
-        vkResetFences(mDevice->GetLogicalDevice(), 1, &mFenceList[mCurrentIndex]);
-
-        // 写入命令缓冲区
+        mFenceWaitTime = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::steady_clock::now() - StartTime).count();
+    }
+    bool Renderer::AcquireFrame(uint32_t *frameIndex)
+    {
+        // 获取交换链下一帧索引
+        VkResult AcquireResult = vkAcquireNextImageKHR(mDevice->GetLogicalDevice(), mDevice->GetSwapchain(), UINT64_MAX, mStartRenderList[mCurrentIndex], nullptr, frameIndex);
+        // 交换链过期时放弃本帧，围栏尚未重置，下一帧可以正常等待
+        if (AcquireResult == VK_ERROR_OUT_OF_DATE_KHR)
         {
-            // 重置命令缓冲区
-            vkResetCommandBuffer(mCommandBufferList[mCurrentIndex], 0);
-
-            // 开始写入命令到命令缓冲区
-            VkCommandBufferBeginInfo CommandBufferBeginInfo{};
-            CommandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-            vkBeginCommandBuffer(mCommandBufferList[mCurrentIndex], &CommandBufferBeginInfo);
+            mIsSwapchainDirty = true;
+            return false;
+        }
+        if (AcquireResult != VK_SUCCESS && AcquireResult != VK_SUBOPTIMAL_KHR)
+        {
+            throw std::runtime_error("Failed to acquire swapchain image!");
+        }
+        // 图像数量多于同时处理的帧数时，获取到的图像可能仍被其他帧使用
+        if (mImageFenceList[*frameIndex] != nullptr && mImageFenceList[*frameIndex] != mFenceList[mCurrentIndex])
+        {
+            vkWaitForFences(mDevice->GetLogicalDevice(), 1, &mImageFenceList[*frameIndex], VK_TRUE, UINT64_MAX);
+        }
+        mImageFenceList[*frameIndex] = mFenceList[mCurrentIndex];
+        return true;
+    }
+    void Renderer::RecordFrame(uint32_t frameIndex, std::function<void(uint32_t)> drawOperations)
+    {
+        std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+        // 重置命令缓冲区
+        vkResetCommandBuffer(mCommandBufferList[mCurrentIndex], 0);
 
-            // 开始记录渲染步骤的命令
-            std::array<VkClearValue, 2> ClearValueList{}; // 定义填充值，与附件参考一一对应
-            ClearValueList[0].color = {{0.0f, 0.0f, 0.0f, 1.0f}};
-            ClearValueList[1].depthStencil = {1.0f, 0};
-            VkRenderPassBeginInfo RenderPassBeginInfo{};
-            RenderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-            RenderPassBeginInfo.renderPass = mDevice->GetRenderPass();
-            RenderPassBeginInfo.framebuffer = mDevice->GetFrameBuffer(mCurrentIndex);
-            RenderPassBeginInfo.renderArea.offset = {0, 0};
-            RenderPassBeginInfo.renderArea.extent = mDevice->GetSwapchainImageExtent();
-            RenderPassBeginInfo.clearValueCount = ClearValueList.size();
-            RenderPassBeginInfo.pClearValues = ClearValueList.data();
-            vkCmdBeginRenderPass(mCommandBufferList[mCurrentIndex], &RenderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+        // 开始写入命令到命令缓冲区
+        VkCommandBufferBeginInfo CommandBufferBeginInfo{};
+        CommandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        CommandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkBeginCommandBuffer(mCommandBufferList[mCurrentIndex], &CommandBufferBeginInfo);
 
-            drawOperations(mCurrentIndex);
+        // 收集本帧的绘制命令
+        mDrawCommandList.clear();
+        mComputeOperationList.clear();
+        mSortIdMap.clear();
+        mGui = nullptr;
+        drawOperations(mCurrentIndex);
+        // 计算命令在渲染流程外录制
+        for (auto &&i : mComputeOperationList)
+        {
+            i(mCommandBufferList[mCurrentIndex]);
+        }
+        // 排序使相同状态的绘制相邻，相同键保持提交顺序
+        std::stable_sort(mDrawCommandList.begin(), mDrawCommandList.end(), [](const DrawCommand &a, const DrawCommand &b)
+                         { return a.SortKey < b.SortKey; });
+        mBindIssuedCount = 0;
+        mBindSkippedCount = 0;
 
-            // 结束记录渲染步骤的命令
-            vkCmdEndRenderPass(mCommandBufferList[mCurrentIndex]);
-            // 结束写入命令到命令缓冲区
-            vkEndCommandBuffer(mCommandBufferList[mCurrentIndex]);
+        // 开始记录渲染步骤的命令，帧缓冲区与获取到的交换链图像对应
+        std::array<VkClearValue, 2> ClearValueList{}; // 定义填充值，与附件参考一一对应
+        ClearValueList[0].color = {{0.0f, 0.0f, 0.0f, 1.0f}};
+        ClearValueList[1].depthStencil = {1.0f, 0};
+        VkRenderPassBeginInfo RenderPassBeginInfo{};
+        RenderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        RenderPassBeginInfo.renderPass = mDevice->GetRenderPass();
+        RenderPassBeginInfo.framebuffer = mDevice->GetFrameBuffer(frameIndex);
+        RenderPassBeginInfo.renderArea.offset = {0, 0};
+        RenderPassBeginInfo.renderArea.extent = mDevice->GetSwapchainImageExtent();
+        RenderPassBeginInfo.clearValueCount = ClearValueList.size();
+        RenderPassBeginInfo.pClearValues = ClearValueList.data();
+        if (mIsParallelRecord)
+        {
+            // 子流程内容全部来自各线程录制的次级命令缓冲区
+            vkCmdBeginRenderPass(mCommandBufferList[mCurrentIndex], &RenderPassBeginInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+            RecordParallel(frameIndex);
+        }
+        else
+        {
+            vkCmdBeginRenderPass(mCommandBufferList[mCurrentIndex], &RenderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+            // 设置视口与剪裁
+            SetViewport(mCommandBufferList[mCurrentIndex], mDevice->GetSwapchainImageExtent());
+            RecordDrawCommand(mCommandBufferList[mCurrentIndex], 0, mDrawCommandList.size());
+            if (mGui != nullptr)
+            {
+                mGui->Draw(mCommandBufferList[mCurrentIndex]);
+            }
+            mRecordThreadUsed = 0;
         }
 
-        // 获取交换链下一帧索引
-        uint32_t FrameIndex = 0;
-        vkAcquireNextImageKHR(mDevice->GetLogicalDevice(), mDevice->GetSwapchain(), UINT64_MAX, mStartRenderList[mCurrentIndex], nullptr, &FrameIndex);
+        // 结束记录渲染步骤的命令
+        vkCmdEndRenderPass(mCommandBufferList[mCurrentIndex]);
+        // 片段着色器写入的存储缓冲区在帧围栏触发后由主机读取
+        VkMemoryBarrier HostReadBarrier{};
+        HostReadBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        HostReadBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        HostReadBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        vkCmdPipelineBarrier(mCommandBufferList[mCurrentIndex],
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0,
+                             1, &HostReadBarrier,
+                             0, nullptr,
+                             0, nullptr);
+        //
+        // 结束写入命令到命令缓冲区
+        vkEndCommandBuffer(mCommandBufferList[mCurrentIndex]);
+        mRecordTime = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::steady_clock::now() - StartTime).count();
+    }
+    void Renderer::SubmitFrame(uint32_t frameIndex)
+    {
+        // 确定提交后再重置同步信号状态
+        vkResetFences(mDevice->GetLogicalDevice(), 1, &mFenceList[mCurrentIndex]);
 
         // 信号组
         VkSemaphore StartRenderS[] = {mStartRenderList[mCurrentIndex]};
-        VkSemaphore SubmitPresentS[] = {mSubmitPresentList[mCurrentIndex]};
+        VkSemaphore SubmitPresentS[] = {mSubmitPresentList[frameIndex]};
 
         // 提交命令缓冲区
+        VkPipelineStageFlags PipelineStageFlagsS[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
+        VkSubmitInfo SubmitInfo{};
+        SubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        SubmitInfo.waitSemaphoreCount = 1;
+        SubmitInfo.pWaitSemaphores = StartRenderS;
+        SubmitInfo.pWaitDstStageMask = PipelineStageFlagsS;
+        SubmitInfo.commandBufferCount = 1;
+        SubmitInfo.pCommandBuffers = &mCommandBufferList[mCurrentIndex];
+        SubmitInfo.signalSemaphoreCount = 1;
+        SubmitInfo.pSignalSemaphores = SubmitPresentS;
+        if (vkQueueSubmit(mDevice->GetGraphicsQueue(), 1, &SubmitInfo, mFenceList[mCurrentIndex]) != VK_SUCCESS)
         {
-            VkPipelineStageFlags PipelineStageFlagsS[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-            VkSubmitInfo SubmitInfo{};
-            SubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-            SubmitInfo.waitSemaphoreCount = 1;
-            SubmitInfo.pWaitSemaphores = StartRenderS;
-            SubmitInfo.pWaitDstStageMask = PipelineStageFlagsS;
-            SubmitInfo.commandBufferCount = 1;
-            SubmitInfo.pCommandBuffers = &mCommandBufferList[mCurrentIndex];
-            SubmitInfo.signalSemaphoreCount = 1;
-            SubmitInfo.pSignalSemaphores = SubmitPresentS;
-            vkQueueSubmit(mDevice->GetGraphicsQueue(), 1, &SubmitInfo, mFenceList[mCurrentIndex]);
+            throw std::runtime_error("Failed to submit draw command buffer!");
         }
+    }
+    void Renderer::PresentFrame(uint32_t frameIndex)
+    {
         // 提交结果到交换链
+        VkSemaphore SubmitPresentS[] = {mSubmitPresentList[frameIndex]};
+        VkSwapchainKHR SwapchainS[] = {mDevice->GetSwapchain()};
+        VkPresentInfoKHR PresentInfo{};
+        PresentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        PresentInfo.waitSemaphoreCount = 1;
+        PresentInfo.pWaitSemaphores = SubmitPresentS;
+        PresentInfo.swapchainCount = 1;
+        PresentInfo.pSwapchains = SwapchainS;
+        PresentInfo.pImageIndices = &frameIndex;
+        VkResult PresentResult = vkQueuePresentKHR(mDevice->GetPresentQueue(), &PresentInfo);
+        if (PresentResult == VK_ERROR_OUT_OF_DATE_KHR || PresentResult == VK_SUBOPTIMAL_KHR)
+        {
+            mIsSwapchainDirty = true;
+        }
+        else if (PresentResult != VK_SUCCESS)
         {
-            // 提交结果
-            VkSwapchainKHR SwapchainS[] = {mDevice->GetSwapchain()};
-            VkPresentInfoKHR PresentInfo{};
-            PresentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-            PresentInfo.waitSemaphoreCount = 1;
-            PresentInfo.pWaitSemaphores = SubmitPresentS;
-            PresentInfo.swapchainCount = 1;
-            PresentInfo.pSwapchains = SwapchainS;
-            PresentInfo.pImageIndices = &FrameIndex;
-            vkQueuePresentKHR(mDevice->GetPresentQueue(), &PresentInfo);
+            throw std::runtime_error("Failed to present swapchain image!");
         }
-        mCurrentIndex = (mCurrentIndex + 1) % mDevice->GetSwapchainImageCount();
     }
 
-    void Renderer::BindPipeline(VkPipeline pipeline)
+    void Renderer::SetViewport(VkCommandBuffer commandBuffer, VkExtent2D extent)
     {
-        vkCmdBindPipeline(mCommandBufferList[mCurrentIndex], VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+        // 视口
+        VkViewport Viewport{};
+        Viewport.x = 0.0f;
+        Viewport.y = 0.0f;
+        Viewport.width = extent.width;
+        Viewport.height = extent.height;
+        Viewport.minDepth = 0.0f;
+        Viewport.maxDepth = 1.0f;
+        vkCmdSetViewport(commandBuffer, 0, 1, &Viewport);
+        // 剪裁
+        VkRect2D Scissor{};
+        Scissor.offset = {0, 0};
+        Scissor.extent = extent;
+        vkCmdSetScissor(commandBuffer, 0, 1, &Scissor);
     }
-    void Renderer::BindVertexBuffer(Buffer::Ptr vertexBuffer)
+    void Renderer::BindPipeline(VkCommandBuffer commandBuffer, VkPipeline pipeline)
+    {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    }
+    void Renderer::BindVertexBuffer(VkCommandBuffer commandBuffer, Buffer::Ptr vertexBuffer)
     {
         VkBuffer VertexBufferS[] = {vertexBuffer->GetBuffer()};
         uint64_t VertexBufferOffsetS[] = {0};
-        vkCmdBindVertexBuffers(mCommandBufferList[mCurrentIndex], 0, 1, VertexBufferS, VertexBufferOffsetS);
+        vkCmdBindVertexBuffers(commandBuffer, 0, 1, VertexBufferS, VertexBufferOffsetS);
     }
-    void Renderer::BindIndexBuffer(Buffer::Ptr vertexIndexBuffer)
+    void Renderer::BindIndexBuffer(VkCommandBuffer commandBuffer, Buffer::Ptr vertexIndexBuffer)
     {
-        vkCmdBindIndexBuffer(mCommandBufferList[mCurrentIndex], vertexIndexBuffer->GetBuffer(), 0, VK_INDEX_TYPE_UINT32);
+        vkCmdBindIndexBuffer(commandBuffer, vertexIndexBuffer->GetBuffer(), 0, VK_INDEX_TYPE_UINT32);
     }
-    void Renderer::BindDescriptorSet(VkPipelineLayout pipelineLayout, VkDescriptorSet descriptorSet)
+    void Renderer::BindDescriptorSet(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, VkDescriptorSet descriptorSet, const std::vector<uint32_t> &dynamicOffsetList)
     {
-        vkCmdBindDescriptorSets(mCommandBufferList[mCurrentIndex],
+        vkCmdBindDescriptorSets(commandBuffer,
                                 VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0,
-                                1, &descriptorSet, 0, nullptr);
+                                1, &descriptorSet, dynamicOffsetList.size(), dynamicOffsetList.data());
+        //
+    }
+    void Renderer::DrawIndexed(VkCommandBuffer commandBuffer, const VkDrawIndexedIndirectCommand &drawParameter)
+    {
+        vkCmdDrawIndexed(commandBuffer, drawParameter.indexCount, drawParameter.instanceCount,
+                         drawParameter.firstIndex, drawParameter.vertexOffset, drawParameter.firstInstance);
         //
     }
-    void Renderer::DrawIndexed(uint32_t vertexIndexCount)
+    void Renderer::DrawIndexedIndirect(VkCommandBuffer commandBuffer, Buffer::Ptr indirectBuffer, uint32_t drawCount)
     {
-        vkCmdDrawIndexed(mCommandBufferList[mCurrentIndex], vertexIndexCount, 1, 0, 0, 0);
+        if (mDevice->IsMultiDrawIndirectSupported())
+        {
+            vkCmdDrawIndexedIndirect(commandBuffer, indirectBuffer->GetBuffer(), 0, drawCount, sizeof(VkDrawIndexedIndirectCommand));
+            return;
+        }
+        for (uint32_t i = 0; i < drawCount; i++)
+        {
+            vkCmdDrawIndexedIndirect(commandBuffer, indirectBuffer->GetBuffer(), i * sizeof(VkDrawIndexedIndirectCommand), 1, sizeof(VkDrawIndexedIndirectCommand));
+        }
+    }
+    void Renderer::DrawIndexedIndirectCount(VkCommandBuffer commandBuffer, Buffer::Ptr indirectBuffer, Buffer::Ptr countBuffer, uint32_t maxDrawCount)
+    {
+        vkCmdDrawIndexedIndirectCount(commandBuffer, indirectBuffer->GetBuffer(), 0, countBuffer->GetBuffer(), 0, maxDrawCount, sizeof(VkDrawIndexedIndirectCommand));
+    }
+    uint16_t Renderer::GetSortId(const void *object)
+    {
+        // 编号按本帧首次出现的顺序分配，保持不同管线之间原有的绘制顺序，超出范围的对象共用最后一个编号，只影响绑定合并
+        auto Iter = mSortIdMap.find(object);
+        if (Iter != mSortIdMap.end())
+        {
+            return Iter->second;
+        }
+        uint16_t Id = std::min<size_t>(mSortIdMap.size(), UINT16_MAX);
+        mSortIdMap.emplace(object, Id);
+        return Id;
     }
-    void Renderer::Draw(ModelBuffer::Ptr modelBuffer, DescriptorSet::Ptr descriptorSet, Pipeline::Ptr pipeline)
+    void Renderer::RecordDrawCommand(VkCommandBuffer commandBuffer, size_t first, size_t last)
     {
-        // 绑定渲染管线
-        BindPipeline(pipeline->GetPipeline());
-        // 绑定顶点缓冲区命令
-        BindVertexBuffer(modelBuffer->GetVertexBuffer());
-        // 绑定顶点索引缓冲区命令
-        BindIndexBuffer(modelBuffer->GetVertexIndexBuffer());
-        // 绑定描述符集命令
-        BindDescriptorSet(descriptorSet->GetPipelineLayout(), descriptorSet->GetDescriptorSet(mCurrentIndex));
-        // 使用带顶点索引的渲染图形命令
-        DrawIndexed(modelBuffer->GetVertexIndexCount());
+        // 次级命令缓冲区不继承绑定状态，每段从空状态开始
+        VkPipeline LastPipeline = nullptr;
+        VkBuffer LastVertexBuffer = nullptr;
+        VkBuffer LastIndexBuffer = nullptr;
+        VkPipelineLayout LastPipelineLayout = nullptr;
+        VkDescriptorSet LastDescriptorSet = nullptr;
+        const std::vector<uint32_t> *pLastDynamicOffsetList = nullptr;
+        uint32_t IssuedCount = 0;
+        uint32_t SkippedCount = 0;
+        for (size_t i = first; i < last; i++)
+        {
+            DrawCommand &Command = mDrawCommandList[i];
+            // 绑定渲染管线
+            VkPipeline CurrentPipeline = Command.GraphicsPipeline->GetPipeline();
+            if (CurrentPipeline != LastPipeline)
+            {
+                BindPipeline(commandBuffer, CurrentPipeline);
+                LastPipeline = CurrentPipeline;
+                IssuedCount++;
+            }
+            else
+            {
+                SkippedCount++;
+            }
+            // 绑定顶点缓冲区命令
+            VkBuffer CurrentVertexBuffer = Command.VertexBuffer->GetBuffer();
+            if (CurrentVertexBuffer != LastVertexBuffer)
+            {
+                BindVertexBuffer(commandBuffer, Command.VertexBuffer);
+                LastVertexBuffer = CurrentVertexBuffer;
+                IssuedCount++;
+            }
+            else
+            {
+                SkippedCount++;
+            }
+            // 绑定顶点索引缓冲区命令
+            VkBuffer CurrentIndexBuffer = Command.VertexIndexBuffer->GetBuffer();
+            if (CurrentIndexBuffer != LastIndexBuffer)
+            {
+                BindIndexBuffer(commandBuffer, Command.VertexIndexBuffer);
+                LastIndexBuffer = CurrentIndexBuffer;
+                IssuedCount++;
+            }
+            else
+            {
+                SkippedCount++;
+            }
+            // 绑定描述符集命令，动态偏移不同时需要重新绑定
+            VkPipelineLayout CurrentPipelineLayout = Command.Descriptor->GetPipelineLayout();
+            VkDescriptorSet CurrentDescriptorSet = Command.Descriptor->GetDescriptorSet(mCurrentIndex);
+            if (CurrentPipelineLayout != LastPipelineLayout || CurrentDescriptorSet != LastDescriptorSet ||
+                pLastDynamicOffsetList == nullptr || *pLastDynamicOffsetList != Command.DynamicOffsetList)
+            {
+                BindDescriptorSet(commandBuffer, CurrentPipelineLayout, CurrentDescriptorSet, Command.DynamicOffsetList);
+                LastPipelineLayout = CurrentPipelineLayout;
+                LastDescriptorSet = CurrentDescriptorSet;
+                pLastDynamicOffsetList = &Command.DynamicOffsetList;
+                IssuedCount++;
+            }
+            else
+            {
+                SkippedCount++;
+            }
+            // 使用带顶点索引的渲染图形命令
+            if (Command.IndirectCountBuffer != nullptr)
+            {
+                DrawIndexedIndirectCount(commandBuffer, Command.IndirectBuffer, Command.IndirectCountBuffer, Command.IndirectDrawCount);
+            }
+            else if (Command.IndirectBuffer != nullptr)
+            {
+                DrawIndexedIndirect(commandBuffer, Command.IndirectBuffer, Command.IndirectDrawCount);
+            }
+            else
+            {
+                DrawIndexed(commandBuffer, Command.DrawParameter);
+            }
+        }
+        mBindIssuedCount += IssuedCount;
+        mBindSkippedCount += SkippedCount;
+    }
+    void Renderer::BeginSecondaryCommandBuffer(VkCommandBuffer commandBuffer, VkFramebuffer frameBuffer)
+    {
+        // 继承主命令缓冲区的渲染流程，动态状态不会继承，需要重新设置
+        VkCommandBufferInheritanceInfo CommandBufferInheritanceInfo{};
+        CommandBufferInheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        CommandBufferInheritanceInfo.renderPass = mDevice->GetRenderPass();
+        CommandBufferInheritanceInfo.subpass = 0;
+        CommandBufferInheritanceInfo.framebuffer = frameBuffer;
+        VkCommandBufferBeginInfo CommandBufferBeginInfo{};
+        CommandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        CommandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+        CommandBufferBeginInfo.pInheritanceInfo = &CommandBufferInheritanceInfo;
+        vkBeginCommandBuffer(commandBuffer, &CommandBufferBeginInfo);
+        SetViewport(commandBuffer, mDevice->GetSwapchainImageExtent());
+    }
+    void Renderer::RecordParallel(uint32_t frameIndex)
+    {
+        std::vector<ThreadCommand> &ThreadCommandList = mThreadCommandList[mCurrentIndex];
+        // 帧围栏已经触发，可以直接重置本帧的全部命令池
+        for (auto &&i : ThreadCommandList)
+        {
+            vkResetCommandPool(mDevice->GetLogicalDevice(), i.CommandPool, 0);
+        }
+        // 绘制数量较少时减少分段，避免空的次级命令缓冲区
+        uint32_t ChunkCount = (mDrawCommandList.size() + mMinDrawPerThread - 1) / mMinDrawPerThread;
+        ChunkCount = std::clamp<uint32_t>(ChunkCount, 1, ThreadCommandList.size() - 1);
+        VkFramebuffer FrameBuffer = mDevice->GetFrameBuffer(frameIndex);
+        // 各任务录制连续的一段绘制命令，保持原有的绘制顺序
+        JobSystem::Counter RecordCounter;
+        for (uint32_t i = 0; i < ChunkCount; i++)
+        {
+            mJobSystem->Run([this, i, ChunkCount, FrameBuffer, &ThreadCommandList]()
+                            {
+                                size_t First = mDrawCommandList.size() * i / ChunkCount;
+                                size_t Last = mDrawCommandList.size() * (i + 1) / ChunkCount;
+                                BeginSecondaryCommandBuffer(ThreadCommandList[i].CommandBuffer, FrameBuffer);
+                                RecordDrawCommand(ThreadCommandList[i].CommandBuffer, First, Last);
+                                vkEndCommandBuffer(ThreadCommandList[i].CommandBuffer); },
+                            &RecordCounter);
+        }
+        // 主线程同时录制ImGui，ImGui上下文不能跨线程使用
+        VkCommandBuffer GuiCommandBuffer = ThreadCommandList.back().CommandBuffer;
+        if (mGui != nullptr)
+        {
+            BeginSecondaryCommandBuffer(GuiCommandBuffer, FrameBuffer);
+            mGui->Draw(GuiCommandBuffer);
+            vkEndCommandBuffer(GuiCommandBuffer);
+        }
+        // 等待全部分段录制完成，主线程在等待期间同样参与录制
+        mJobSystem->Wait(&RecordCounter);
+        // 按顺序执行次级命令缓冲区
+        std::vector<VkCommandBuffer> SecondaryCommandBufferList;
+        for (uint32_t i = 0; i < ChunkCount; i++)
+        {
+            SecondaryCommandBufferList.push_back(ThreadCommandList[i].CommandBuffer);
+        }
+        if (mGui != nullptr)
+        {
+            SecondaryCommandBufferList.push_back(GuiCommandBuffer);
+        }
+        vkCmdExecuteCommands(mCommandBufferList[mCurrentIndex], SecondaryCommandBufferList.size(), SecondaryCommandBufferList.data());
+        mRecordThreadUsed = ChunkCount;
+    }
+    void Renderer::Draw(ModelBuffer::Ptr modelBuffer, DescriptorSet::Ptr descriptorSet, Pipeline::Ptr pipeline, std::vector<uint32_t> dynamicOffsetList, float depth)
+    {
+        DrawInstanced(modelBuffer, descriptorSet, pipeline, 1, std::move(dynamicOffsetList), depth);
+    }
+    void Renderer::DrawInstanced(ModelBuffer::Ptr modelBuffer, DescriptorSet::Ptr descriptorSet, Pipeline::Ptr pipeline, uint32_t instanceCount,
+                                 std::vector<uint32_t> dynamicOffsetList, float depth)
+    {
+        if (instanceCount == 0)
+        {
+            return;
+        }
+        DrawCommand Command{};
+        Command.VertexBuffer = modelBuffer->GetVertexBuffer();
+        Command.VertexIndexBuffer = modelBuffer->GetVertexIndexBuffer();
+        Command.Descriptor = descriptorSet;
+        Command.GraphicsPipeline = pipeline;
+        Command.DynamicOffsetList = std::move(dynamicOffsetList);
+        Command.DrawParameter.indexCount = modelBuffer->GetVertexIndexCount();
+        Command.DrawParameter.instanceCount = instanceCount;
+        PushDrawCommand(std::move(Command), depth);
+    }
+    void Renderer::DrawMesh(GeometryPool::Ptr geometryPool, const GeometryPool::Mesh &mesh, DescriptorSet::Ptr descriptorSet, Pipeline::Ptr pipeline, uint32_t firstInstance,
+                            std::vector<uint32_t> dynamicOffsetList, float depth)
+    {
+        DrawCommand Command{};
+        Command.VertexBuffer = geometryPool->GetVertexBuffer();
+        Command.VertexIndexBuffer = geometryPool->GetVertexIndexBuffer();
+        Command.Descriptor = descriptorSet;
+        Command.GraphicsPipeline = pipeline;
+        Command.DynamicOffsetList = std::move(dynamicOffsetList);
+        Command.DrawParameter.indexCount = mesh.IndexCount;
+        Command.DrawParameter.instanceCount = 1;
+        Command.DrawParameter.firstIndex = mesh.FirstIndex;
+        Command.DrawParameter.vertexOffset = mesh.VertexOffset;
+        Command.DrawParameter.firstInstance = firstInstance;
+        PushDrawCommand(std::move(Command), depth);
+    }
+    void Renderer::DrawIndirect(GeometryPool::Ptr geometryPool, DescriptorSet::Ptr descriptorSet, Pipeline::Ptr pipeline, Buffer::Ptr indirectBuffer, uint32_t drawCount,
+                                std::vector<uint32_t> dynamicOffsetList, float depth)
+    {
+        if (drawCount == 0)
+        {
+            return;
+        }
+        DrawCommand Command{};
+        Command.VertexBuffer = geometryPool->GetVertexBuffer();
+        Command.VertexIndexBuffer = geometryPool->GetVertexIndexBuffer();
+        Command.Descriptor = descriptorSet;
+        Command.GraphicsPipeline = pipeline;
+        Command.DynamicOffsetList = std::move(dynamicOffsetList);
+        Command.IndirectBuffer = indirectBuffer;
+        Command.IndirectDrawCount = drawCount;
+        PushDrawCommand(std::move(Command), depth);
+    }
+    void Renderer::DrawIndirectCount(GeometryPool::Ptr geometryPool, DescriptorSet::Ptr descriptorSet, Pipeline::Ptr pipeline, Buffer::Ptr indirectBuffer, Buffer::Ptr countBuffer,
+                                     uint32_t maxDrawCount, std::vector<uint32_t> dynamicOffsetList, float depth)
+    {
+        if (maxDrawCount == 0)
+        {
+            return;
+        }
+        DrawCommand Command{};
+        Command.VertexBuffer = geometryPool->GetVertexBuffer();
+        Command.VertexIndexBuffer = geometryPool->GetVertexIndexBuffer();
+        Command.Descriptor = descriptorSet;
+        Command.GraphicsPipeline = pipeline;
+        Command.DynamicOffsetList = std::move(dynamicOffsetList);
+        Command.IndirectBuffer = indirectBuffer;
+        Command.IndirectDrawCount = maxDrawCount;
+        Command.IndirectCountBuffer = countBuffer;
+        PushDrawCommand(std::move(Command), depth);
+    }
+    void Renderer::Compute(std::function<void(VkCommandBuffer)> computeOperation)
+    {
+        mComputeOperationList.push_back(computeOperation);
+    }
+    void Renderer::PushDrawCommand(DrawCommand command, float depth)
+    {
+        // 深度量化为16位，网格编号按顶点缓冲区分配，同一几何池中的网格相邻
+        uint64_t DepthKey = std::clamp(depth / mSortDepthRange, 0.0f, 1.0f) * UINT16_MAX;
+        // 半透明绘制需要从远到近混合，深度取反
+        bool IsTranslucent = command.GraphicsPipeline->IsTranslucent();
+        if (IsTranslucent)
+        {
+            DepthKey = UINT16_MAX - DepthKey;
+        }
+        command.SortKey = (uint64_t)IsTranslucent << 63 |
+                          (uint64_t)(GetSortId(command.GraphicsPipeline.get()) & 0x7FFF) << 48 |
+                          (uint64_t)GetSortId(command.Descriptor.get()) << 32 |
+                          (uint64_t)GetSortId(command.VertexBuffer.get()) << 16 |
+                          DepthKey;
+        mDrawCommandList.push_back(std::move(command));
     }
     void Renderer::DrawGUI(Gui::Ptr gui)
     {
-        gui->Draw(mCommandBufferList[mCurrentIndex]);
+        mGui = gui;
     }
 } // namespace vk
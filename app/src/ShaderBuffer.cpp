@@ -2,9 +2,22 @@
 
 namespace vk
 {
-    ShaderBuffer::ShaderBuffer(Device::Ptr device, size_t bufferSize, bool isWritePerFrame)
-        : mDevice(device), mIsWritePerFrame(isWritePerFrame)
+    ShaderBuffer::ShaderBuffer(Device::Ptr device, size_t bufferSize, bool isWritePerFrame, uint32_t dynamicElementCount, bool isStorage)
+        : mDevice(device), mIsWritePerFrame(isWritePerFrame), mDataSize(bufferSize), mIsStorage(isStorage)
     {
+        if (isStorage && dynamicElementCount > 0)
+        {
+            throw std::runtime_error("Storage shader buffer can not be dynamic!");
+        }
+        if (dynamicElementCount > 0)
+        {
+            if (!isWritePerFrame)
+            {
+                throw std::runtime_error("Dynamic shader buffer must be written per frame!");
+            }
+            mIsDynamic = true;
+            mElementCount = dynamicElementCount;
+        }
         CreateShaderBuffer(bufferSize);
     }
     ShaderBuffer::~ShaderBuffer()
@@ -13,24 +26,36 @@ namespace vk
 
     void ShaderBuffer::CreateShaderBuffer(size_t bufferSize)
     {
+        VkBufferUsageFlags BufferUsage = mIsStorage ? VK_BUFFER_USAGE_STORAGE_BUFFER_BIT : VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
         // 创建世界空间缓冲区
         if (mIsWritePerFrame)
         {
-            mShaderBuffer.resize(mDevice->GetSwapchainImageCount());
-            for (auto &&i : mShaderBuffer)
+            // 每帧区段按最小偏移对齐，整块主机可见且常驻映射，写入只需拷贝内存
+            VkPhysicalDeviceProperties PhysicalDeviceProperties{};
+            vkGetPhysicalDeviceProperties(mDevice->GetPhysicalDevice(), &PhysicalDeviceProperties);
+            VkDeviceSize Alignment = std::max<VkDeviceSize>(mIsStorage ? PhysicalDeviceProperties.limits.minStorageBufferOffsetAlignment
+                                                                       : PhysicalDeviceProperties.limits.minUniformBufferOffsetAlignment,
+                                                            1);
+            mElementStride = (bufferSize + Alignment - 1) / Alignment * Alignment;
+            mSliceSize = mElementStride * mElementCount;
+            mSliceCount = mDevice->GetFrameInFlightCount();
+            mShaderBuffer = Buffer::New(mDevice, mSliceSize * mSliceCount,
+                                        BufferUsage,
+                                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+            //
+            if (mShaderBuffer->GetMappedData() == nullptr)
             {
-                i = Buffer::New(mDevice, bufferSize,
-                                    VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-                                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-                //
+                throw std::runtime_error("Failed to map shader buffer!");
             }
         }
         else
         {
-            mShaderBuffer.resize(1);
-            mShaderBuffer[0] = Buffer::New(mDevice, bufferSize,
-                                               VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-                                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+            mElementStride = bufferSize;
+            mSliceSize = bufferSize;
+            mSliceCount = 1;
+            mShaderBuffer = Buffer::New(mDevice, bufferSize,
+                                        VK_BUFFER_USAGE_TRANSFER_DST_BIT | BufferUsage,
+                                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
             //
         }
     }
@@ -39,21 +64,12 @@ namespace vk
         for (auto &&j : descriptorSetList)
         {
             // 更新描述符
-            for (size_t i = 0; i < mDevice->GetSwapchainImageCount(); i++)
+            for (uint32_t i = 0; i < mDevice->GetFrameInFlightCount(); i++)
             {
                 VkDescriptorBufferInfo DescriptorBufferInfo{};
-                if (mIsWritePerFrame)
-                {
-                    DescriptorBufferInfo.buffer = mShaderBuffer[i]->GetBuffer();
-                    DescriptorBufferInfo.offset = 0;
-                    DescriptorBufferInfo.range = mShaderBuffer[i]->GetBufferSize();
-                }
-                else
-                {
-                    DescriptorBufferInfo.buffer = mShaderBuffer[0]->GetBuffer();
-                    DescriptorBufferInfo.offset = 0;
-                    DescriptorBufferInfo.range = mShaderBuffer[0]->GetBufferSize();
-                }
+                DescriptorBufferInfo.buffer = mShaderBuffer->GetBuffer();
+                DescriptorBufferInfo.offset = GetOffset(i);
+                DescriptorBufferInfo.range = mDataSize; // 动态统一缓冲区的描述符只覆盖一个对象，由动态偏移选择
 
                 VkWriteDescriptorSet WriteDescriptorSet{};
                 WriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
@@ -61,7 +77,9 @@ namespace vk
                 WriteDescriptorSet.dstBinding = dstBinding;
                 WriteDescriptorSet.dstArrayElement = 0;
                 WriteDescriptorSet.descriptorCount = 1;
-                WriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+                WriteDescriptorSet.descriptorType = mIsStorage   ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+                                                    : mIsDynamic ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC
+                                                                 : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
                 WriteDescriptorSet.pBufferInfo = &DescriptorBufferInfo;
                 vkUpdateDescriptorSets(mDevice->GetLogicalDevice(), 1, &WriteDescriptorSet, 0, nullptr);
             }
@@ -69,13 +87,43 @@ namespace vk
     }
     void ShaderBuffer::WriteData(uint32_t currentIndex, void *data)
     {
-        mShaderBuffer[currentIndex]->WriteData(data);
+        if (mIsWritePerFrame)
+        {
+            memcpy(static_cast<char *>(mShaderBuffer->GetMappedData()) + GetOffset(currentIndex), data, mDataSize);
+        }
+        else
+        {
+            mShaderBuffer->WriteData(data);
+        }
     }
     void ShaderBuffer::AllWriteData(void *data)
     {
-        for (auto &&i : mShaderBuffer)
+        for (uint32_t i = 0; i < mSliceCount; i++)
+        {
+            WriteData(i, data);
+        }
+    }
+    void ShaderBuffer::ReadData(uint32_t currentIndex, void *data)
+    {
+        if (!mIsWritePerFrame)
+        {
+            return;
+        }
+        memcpy(data, static_cast<char *>(mShaderBuffer->GetMappedData()) + GetOffset(currentIndex), mDataSize);
+    }
+    void ShaderBuffer::WriteElementData(uint32_t currentIndex, uint32_t elementIndex, void *data)
+    {
+        if (!mIsDynamic || elementIndex >= mElementCount)
+        {
+            return;
+        }
+        memcpy(static_cast<char *>(mShaderBuffer->GetMappedData()) + GetOffset(currentIndex) + GetDynamicOffset(elementIndex), data, mDataSize);
+    }
+    void ShaderBuffer::AllWriteElementData(uint32_t elementIndex, void *data)
+    {
+        for (uint32_t i = 0; i < mSliceCount; i++)
         {
-            i->WriteData(data);
+            WriteElementData(i, elementIndex, data);
         }
     }
 } // namespace vk
@@ -3,9 +3,13 @@
 namespace vk
 {
     ShaderImage::ShaderImage(Device::Ptr device, uint32_t width, uint32_t height, bool isWritePerFrame)
+        : ShaderImage(device, width, height, VK_FORMAT_R8G8B8A8_SRGB, 0, isWritePerFrame)
+    {
+    }
+    ShaderImage::ShaderImage(Device::Ptr device, uint32_t width, uint32_t height, VkFormat format, uint32_t mipLevels, bool isWritePerFrame)
         : mDevice(device), mIsWritePerFrame(isWritePerFrame)
     {
-        CreateShaderImage(width, height);
+        CreateShaderImage(width, height, format, mipLevels);
         CreateShaderSampler();
     }
     ShaderImage::~ShaderImage()
@@ -17,14 +21,14 @@ namespace vk
         }
     }
 
-    void ShaderImage::CreateShaderImage(uint32_t width, uint32_t height)
+    void ShaderImage::CreateShaderImage(uint32_t width, uint32_t height, VkFormat format, uint32_t mipLevels)
     {
         if (mIsWritePerFrame)
         {
-            mShaderImage.resize(mDevice->GetSwapchainImageCount());
+            mShaderImage.resize(mDevice->GetFrameInFlightCount());
             for (auto &&i : mShaderImage)
             {
-                i = Image::New(mDevice, width, height,
+                i = Image::New(mDevice, width, height, format, mipLevels,
                                    VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
                                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
                 //
@@ -33,7 +37,7 @@ namespace vk
         else
         {
             mShaderImage.resize(1);
-            mShaderImage[0] = Image::New(mDevice, width, height,
+            mShaderImage[0] = Image::New(mDevice, width, height, format, mipLevels,
                                              VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
                                              VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
             //
@@ -63,12 +67,12 @@ namespace vk
         SamplerCreateInfo.maxLod = mShaderImage[0]->GetMipLevels();
         vkCreateSampler(mDevice->GetLogicalDevice(), &SamplerCreateInfo, nullptr, &mImageSampler);
     }
-    void ShaderImage::WriteDescriptorSet(std::vector<DescriptorSet::Ptr> descriptorSetList, uint32_t dstBinding)
+    void ShaderImage::WriteDescriptorSet(std::vector<DescriptorSet::Ptr> descriptorSetList, uint32_t dstBinding, uint32_t dstArrayElement)
     {
         for (auto &&j : descriptorSetList)
         {
             // 更新描述符
-            for (size_t i = 0; i < mDevice->GetSwapchainImageCount(); i++)
+            for (size_t i = 0; i < mDevice->GetFrameInFlightCount(); i++)
             {
                 VkDescriptorImageInfo SamplerImageInfo{};
                 if (mIsWritePerFrame)
@@ -88,7 +92,7 @@ namespace vk
                 WriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
                 WriteDescriptorSet.dstSet = j->GetDescriptorSet(i);
                 WriteDescriptorSet.dstBinding = dstBinding;
-                WriteDescriptorSet.dstArrayElement = 0;
+                WriteDescriptorSet.dstArrayElement = dstArrayElement;
                 WriteDescriptorSet.descriptorCount = 1;
                 WriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
                 WriteDescriptorSet.pImageInfo = &SamplerImageInfo;
@@ -96,6 +100,25 @@ namespace vk
             }
         }
     }
+    void ShaderImage::WriteDescriptorSet(uint32_t currentIndex, std::vector<DescriptorSet::Ptr> descriptorSetList, uint32_t dstBinding, uint32_t dstArrayElement)
+    {
+        VkDescriptorImageInfo SamplerImageInfo{};
+        SamplerImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        SamplerImageInfo.imageView = mShaderImage[mIsWritePerFrame ? currentIndex : 0]->GetImageView();
+        SamplerImageInfo.sampler = mImageSampler;
+        for (auto &&i : descriptorSetList)
+        {
+            VkWriteDescriptorSet WriteDescriptorSet{};
+            WriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            WriteDescriptorSet.dstSet = i->GetDescriptorSet(currentIndex);
+            WriteDescriptorSet.dstBinding = dstBinding;
+            WriteDescriptorSet.dstArrayElement = dstArrayElement;
+            WriteDescriptorSet.descriptorCount = 1;
+            WriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            WriteDescriptorSet.pImageInfo = &SamplerImageInfo;
+            vkUpdateDescriptorSets(mDevice->GetLogicalDevice(), 1, &WriteDescriptorSet, 0, nullptr);
+        }
+    }
     bool ShaderImage::WriteData(uint32_t currentIndex, void *data)
     {
         if (!mShaderImage[currentIndex]->WriteData(data))
@@ -115,4 +138,15 @@ namespace vk
         }
         return true;
     }
+    bool ShaderImage::AllWriteCompressedData(const uint8_t *data, const std::vector<TextureCompressor::MipLevel> &mipLevelList)
+    {
+        for (auto &&i : mShaderImage)
+        {
+            if (!i->WriteCompressedData(data, mipLevelList))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
 } // namespace vk
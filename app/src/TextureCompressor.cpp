@@ -0,0 +1,345 @@
+#include "vk/TextureCompressor.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+namespace vk
+{
+    namespace
+    {
+        // sRGB与线性空间转换，解码使用查找表，多个线程同时编码时只初始化一次
+        const float *GetSrgbToLinearTable()
+        {
+            static const std::array<float, 256> Table = []()
+            {
+                std::array<float, 256> Result{};
+                for (int i = 0; i < 256; i++)
+                {
+                    float Value = i / 255.0f;
+                    Result[i] = Value <= 0.04045f ? Value / 12.92f : std::pow((Value + 0.055f) / 1.055f, 2.4f);
+                }
+                return Result;
+            }();
+            return Table.data();
+        }
+        uint8_t LinearToSrgb(float value)
+        {
+            value = std::clamp(value, 0.0f, 1.0f);
+            float Srgb = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+            return static_cast<uint8_t>(Srgb * 255.0f + 0.5f);
+        }
+        // 565颜色的打包与展开
+        uint16_t PackColor(const float *color)
+        {
+            uint32_t R = static_cast<uint32_t>(std::clamp(color[0], 0.0f, 255.0f) * 31.0f / 255.0f + 0.5f);
+            uint32_t G = static_cast<uint32_t>(std::clamp(color[1], 0.0f, 255.0f) * 63.0f / 255.0f + 0.5f);
+            uint32_t B = static_cast<uint32_t>(std::clamp(color[2], 0.0f, 255.0f) * 31.0f / 255.0f + 0.5f);
+            return static_cast<uint16_t>((R << 11) | (G << 5) | B);
+        }
+        void UnpackColor(uint16_t color, int *rgb)
+        {
+            int R = (color >> 11) & 31;
+            int G = (color >> 5) & 63;
+            int B = color & 31;
+            rgb[0] = (R << 3) | (R >> 2);
+            rgb[1] = (G << 2) | (G >> 4);
+            rgb[2] = (B << 3) | (B >> 2);
+        }
+    } // namespace
+
+    void TextureCompressor::CompressColorBlock(const uint8_t *pixel, uint8_t *block)
+    {
+        // 端点取颜色分布的主轴两端，主轴由协方差矩阵幂迭代求得
+        float Mean[3]{};
+        for (int i = 0; i < 16; i++)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                Mean[c] += pixel[i * 4 + c];
+            }
+        }
+        for (int c = 0; c < 3; c++)
+        {
+            Mean[c] /= 16.0f;
+        }
+        float Covariance[6]{};
+        for (int i = 0; i < 16; i++)
+        {
+            float R = pixel[i * 4 + 0] - Mean[0];
+            float G = pixel[i * 4 + 1] - Mean[1];
+            float B = pixel[i * 4 + 2] - Mean[2];
+            Covariance[0] += R * R;
+            Covariance[1] += R * G;
+            Covariance[2] += R * B;
+            Covariance[3] += G * G;
+            Covariance[4] += G * B;
+            Covariance[5] += B * B;
+        }
+        float Axis[3]{1.0f, 1.0f, 1.0f};
+        for (int Iteration = 0; Iteration < 8; Iteration++)
+        {
+            float X = Covariance[0] * Axis[0] + Covariance[1] * Axis[1] + Covariance[2] * Axis[2];
+            float Y = Covariance[1] * Axis[0] + Covariance[3] * Axis[1] + Covariance[4] * Axis[2];
+            float Z = Covariance[2] * Axis[0] + Covariance[4] * Axis[1] + Covariance[5] * Axis[2];
+            float Length = std::max({std::abs(X), std::abs(Y), std::abs(Z)});
+            if (Length < 1e-6f)
+            {
+                break;
+            }
+            Axis[0] = X / Length;
+            Axis[1] = Y / Length;
+            Axis[2] = Z / Length;
+        }
+        float AxisLength = Axis[0] * Axis[0] + Axis[1] * Axis[1] + Axis[2] * Axis[2];
+        float MinProject = 0;
+        float MaxProject = 0;
+        for (int i = 0; i < 16; i++)
+        {
+            float Project = (pixel[i * 4 + 0] - Mean[0]) * Axis[0] + (pixel[i * 4 + 1] - Mean[1]) * Axis[1] + (pixel[i * 4 + 2] - Mean[2]) * Axis[2];
+            MinProject = std::min(MinProject, Project);
+            MaxProject = std::max(MaxProject, Project);
+        }
+        float MaxColor[3];
+        float MinColor[3];
+        for (int c = 0; c < 3; c++)
+        {
+            MaxColor[c] = Mean[c] + Axis[c] * MaxProject / AxisLength;
+            MinColor[c] = Mean[c] + Axis[c] * MinProject / AxisLength;
+        }
+        uint16_t Color0 = PackColor(MaxColor);
+        uint16_t Color1 = PackColor(MinColor);
+        // 四色模式要求Color0大于Color1
+        if (Color0 < Color1)
+        {
+            std::swap(Color0, Color1);
+        }
+        uint32_t Indices = 0;
+        if (Color0 != Color1)
+        {
+            int Palette[4][3];
+            UnpackColor(Color0, Palette[0]);
+            UnpackColor(Color1, Palette[1]);
+            for (int c = 0; c < 3; c++)
+            {
+                Palette[2][c] = (2 * Palette[0][c] + Palette[1][c]) / 3;
+                Palette[3][c] = (Palette[0][c] + 2 * Palette[1][c]) / 3;
+            }
+            for (int i = 0; i < 16; i++)
+            {
+                uint32_t BestIndex = 0;
+                int BestDistance = INT32_MAX;
+                for (uint32_t j = 0; j < 4; j++)
+                {
+                    int R = pixel[i * 4 + 0] - Palette[j][0];
+                    int G = pixel[i * 4 + 1] - Palette[j][1];
+                    int B = pixel[i * 4 + 2] - Palette[j][2];
+                    int Distance = R * R + G * G + B * B;
+                    if (Distance < BestDistance)
+                    {
+                        BestDistance = Distance;
+                        BestIndex = j;
+                    }
+                }
+                Indices |= BestIndex << (i * 2);
+            }
+        }
+        // 小端序写入端点与索引
+        block[0] = Color0 & 0xFF;
+        block[1] = Color0 >> 8;
+        block[2] = Color1 & 0xFF;
+        block[3] = Color1 >> 8;
+        for (int i = 0; i < 4; i++)
+        {
+            block[4 + i] = (Indices >> (i * 8)) & 0xFF;
+        }
+    }
+    void TextureCompressor::CompressAlphaBlock(const uint8_t *pixel, uint8_t *block)
+    {
+        // 使用八级插值模式，端点为最大与最小透明度
+        int Alpha0 = 0;
+        int Alpha1 = 255;
+        for (int i = 0; i < 16; i++)
+        {
+            Alpha0 = std::max<int>(Alpha0, pixel[i * 4 + 3]);
+            Alpha1 = std::min<int>(Alpha1, pixel[i * 4 + 3]);
+        }
+        uint64_t Indices = 0;
+        if (Alpha0 != Alpha1)
+        {
+            int Palette[8];
+            Palette[0] = Alpha0;
+            Palette[1] = Alpha1;
+            for (int j = 1; j < 7; j++)
+            {
+                Palette[j + 1] = ((7 - j) * Alpha0 + j * Alpha1) / 7;
+            }
+            for (int i = 0; i < 16; i++)
+            {
+                uint64_t BestIndex = 0;
+                int BestDistance = INT32_MAX;
+                for (uint64_t j = 0; j < 8; j++)
+                {
+                    int Distance = std::abs(pixel[i * 4 + 3] - Palette[j]);
+                    if (Distance < BestDistance)
+                    {
+                        BestDistance = Distance;
+                        BestIndex = j;
+                    }
+                }
+                Indices |= BestIndex << (i * 3);
+            }
+        }
+        block[0] = Alpha0;
+        block[1] = Alpha1;
+        for (int i = 0; i < 6; i++)
+        {
+            block[2 + i] = (Indices >> (i * 8)) & 0xFF;
+        }
+    }
+    void TextureCompressor::CompressLevel(const uint8_t *rgba, uint32_t width, uint32_t height, Format format, uint8_t *data)
+    {
+        if (format == Format::RGBA8)
+        {
+            memcpy(data, rgba, GetLevelSize(format, width, height));
+            return;
+        }
+        uint32_t BlockCountX = (width + 3) / 4;
+        uint32_t BlockCountY = (height + 3) / 4;
+        uint32_t BlockSize = GetBlockSize(format);
+        uint8_t Pixel[64];
+        for (uint32_t BlockY = 0; BlockY < BlockCountY; BlockY++)
+        {
+            for (uint32_t BlockX = 0; BlockX < BlockCountX; BlockX++)
+            {
+                for (uint32_t y = 0; y < 4; y++)
+                {
+                    for (uint32_t x = 0; x < 4; x++)
+                    {
+                        uint32_t SrcX = std::min(BlockX * 4 + x, width - 1);
+                        uint32_t SrcY = std::min(BlockY * 4 + y, height - 1);
+                        memcpy(Pixel + (y * 4 + x) * 4, rgba + (static_cast<size_t>(SrcY) * width + SrcX) * 4, 4);
+                    }
+                }
+                uint8_t *Block = data + (static_cast<size_t>(BlockY) * BlockCountX + BlockX) * BlockSize;
+                if (format == Format::BC3)
+                {
+                    CompressAlphaBlock(Pixel, Block);
+                    Block += 8;
+                }
+                CompressColorBlock(Pixel, Block);
+            }
+        }
+    }
+    void TextureCompressor::GenerateMipLevel(const std::vector<float> &srcLinear, uint32_t srcWidth, uint32_t srcHeight, std::vector<float> *dstLinear)
+    {
+        uint32_t DstWidth = std::max(1u, srcWidth / 2);
+        uint32_t DstHeight = std::max(1u, srcHeight / 2);
+        dstLinear->resize(static_cast<size_t>(DstWidth) * DstHeight * 4);
+        for (uint32_t y = 0; y < DstHeight; y++)
+        {
+            uint32_t SrcY0 = std::min(y * 2, srcHeight - 1);
+            uint32_t SrcY1 = std::min(y * 2 + 1, srcHeight - 1);
+            for (uint32_t x = 0; x < DstWidth; x++)
+            {
+                uint32_t SrcX0 = std::min(x * 2, srcWidth - 1);
+                uint32_t SrcX1 = std::min(x * 2 + 1, srcWidth - 1);
+                const float *P00 = srcLinear.data() + (static_cast<size_t>(SrcY0) * srcWidth + SrcX0) * 4;
+                const float *P01 = srcLinear.data() + (static_cast<size_t>(SrcY0) * srcWidth + SrcX1) * 4;
+                const float *P10 = srcLinear.data() + (static_cast<size_t>(SrcY1) * srcWidth + SrcX0) * 4;
+                const float *P11 = srcLinear.data() + (static_cast<size_t>(SrcY1) * srcWidth + SrcX1) * 4;
+                float *Dst = dstLinear->data() + (static_cast<size_t>(y) * DstWidth + x) * 4;
+                for (int c = 0; c < 4; c++)
+                {
+                    Dst[c] = (P00[c] + P01[c] + P10[c] + P11[c]) * 0.25f;
+                }
+            }
+        }
+    }
+    void TextureCompressor::LinearToRgba(const std::vector<float> &linear, std::vector<uint8_t> *rgba)
+    {
+        rgba->resize(linear.size());
+        for (size_t i = 0; i < linear.size(); i += 4)
+        {
+            (*rgba)[i + 0] = LinearToSrgb(linear[i + 0]);
+            (*rgba)[i + 1] = LinearToSrgb(linear[i + 1]);
+            (*rgba)[i + 2] = LinearToSrgb(linear[i + 2]);
+            (*rgba)[i + 3] = static_cast<uint8_t>(std::clamp(linear[i + 3], 0.0f, 1.0f) * 255.0f + 0.5f);
+        }
+    }
+
+    uint32_t TextureCompressor::GetMipLevelCount(uint32_t width, uint32_t height)
+    {
+        uint32_t LevelCount = 1;
+        for (uint32_t Size = std::max(width, height); Size > 1; Size /= 2)
+        {
+            LevelCount++;
+        }
+        return LevelCount;
+    }
+    bool TextureCompressor::HasAlpha(const uint8_t *rgba, uint32_t width, uint32_t height)
+    {
+        size_t PixelCount = static_cast<size_t>(width) * height;
+        for (size_t i = 0; i < PixelCount; i++)
+        {
+            if (rgba[i * 4 + 3] != 255)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+    TextureCompressor::CompressedImage TextureCompressor::Compress(const uint8_t *rgba, uint32_t width, uint32_t height, Format format, bool isGenerateMip)
+    {
+        CompressedImage Image{};
+        Image.ImageFormat = format;
+        Image.Width = width;
+        Image.Height = height;
+        if (rgba == nullptr || width == 0 || height == 0)
+        {
+            return Image;
+        }
+        // 先计算所有级别的偏移，一次分配输出内存
+        uint32_t LevelCount = isGenerateMip ? GetMipLevelCount(width, height) : 1;
+        uint64_t Offset = 0;
+        for (uint32_t i = 0; i < LevelCount; i++)
+        {
+            MipLevel Level{};
+            Level.Width = std::max(1u, width >> i);
+            Level.Height = std::max(1u, height >> i);
+            Level.Offset = Offset;
+            Level.Size = GetLevelSize(format, Level.Width, Level.Height);
+            Image.MipLevelList.push_back(Level);
+            Offset += Level.Size;
+        }
+        Image.Data.resize(Offset);
+        // 原图直接编码，其余级别在线性空间中逐级缩小后编码
+        CompressLevel(rgba, width, height, format, Image.Data.data());
+        if (LevelCount == 1)
+        {
+            return Image;
+        }
+        const float *SrgbToLinear = GetSrgbToLinearTable();
+        std::vector<float> Linear(static_cast<size_t>(width) * height * 4);
+        for (size_t i = 0; i < Linear.size(); i += 4)
+        {
+            Linear[i + 0] = SrgbToLinear[rgba[i + 0]];
+            Linear[i + 1] = SrgbToLinear[rgba[i + 1]];
+            Linear[i + 2] = SrgbToLinear[rgba[i + 2]];
+            Linear[i + 3] = rgba[i + 3] / 255.0f;
+        }
+        std::vector<float> NextLinear;
+        std::vector<uint8_t> LevelRgba;
+        for (uint32_t i = 1; i < LevelCount; i++)
+        {
+            const MipLevel &SrcLevel = Image.MipLevelList[i - 1];
+            const MipLevel &DstLevel = Image.MipLevelList[i];
+            GenerateMipLevel(Linear, SrcLevel.Width, SrcLevel.Height, &NextLinear);
+            Linear.swap(NextLinear);
+            LinearToRgba(Linear, &LevelRgba);
+            CompressLevel(LevelRgba.data(), DstLevel.Width, DstLevel.Height, format, Image.Data.data() + DstLevel.Offset);
+        }
+        return Image;
+    }
+} // namespace vk
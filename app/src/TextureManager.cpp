@@ -0,0 +1,483 @@
+#include "vk/TextureManager.h"
+
+namespace vk
+{
+    TextureManager::TextureManager(Device::Ptr device, uint32_t decodeThreadCount)
+        : mDevice(device)
+    {
+        mDecodeJobSystem = JobSystem::New(std::max(1u, decodeThreadCount));
+    }
+    TextureManager::~TextureManager()
+    {
+        // 等待解码任务结束，释放未上传的解码结果
+        mDecodeJobSystem->Wait(&mDecodeCounter);
+        for (auto &&i : mDecodeResultList)
+        {
+            i.Info.Free();
+        }
+    }
+
+    bool TextureManager::OpenCompressedFile(std::string filePath, DecodeResult *decodeResult)
+    {
+        std::string BakedFilePath = GetBakedPath(filePath);
+        if (!std::filesystem::exists(BakedFilePath))
+        {
+            return false;
+        }
+        MappedFile::Ptr File = MappedFile::New(BakedFilePath);
+        uint64_t SourceHash = 0;
+        if (!DdsFile::Parse(File->GetData(), File->GetSize(), &decodeResult->CompressedInfo, &decodeResult->CompressedData, &SourceHash))
+        {
+            printf("Failed to parse baked texture: %s\n", BakedFilePath.c_str());
+            return false;
+        }
+        // 烘焙后源文件被修改或没有记录源文件哈希时重新解码源文件
+        MappedFile::Ptr SourceFile = MappedFile::New(filePath);
+        if (SourceFile->GetData() != nullptr && SourceHash != ContentHash::Hash(SourceFile->GetData(), SourceFile->GetSize()))
+        {
+            printf("Baked texture is out of date: %s\n", BakedFilePath.c_str());
+            return false;
+        }
+        decodeResult->CompressedFile = File;
+        return true;
+    }
+    TextureManager::DecodeResult TextureManager::Decode(Handle handle, std::string filePath, bool isCompressedSupported, bool isStreamed)
+    {
+        DecodeResult Result{};
+        Result.TextureHandle = handle;
+        Result.IsStreamed = isStreamed;
+        std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+        // 优先使用烘焙文件，数据在上传时才从映射中读入
+        if (isCompressedSupported && OpenCompressedFile(filePath, &Result))
+        {
+            Result.DecodeTime = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::steady_clock::now() - StartTime).count();
+            return Result;
+        }
+        Result.Info = Image::OpenImageFile(filePath);
+        // 流送纹理在解码线程上生成完整的mip链，之后按级别上传
+        if (isStreamed && Result.Info.Data != nullptr)
+        {
+            Result.CompressedInfo = TextureCompressor::Compress(static_cast<const uint8_t *>(Result.Info.Data), Result.Info.Width, Result.Info.Height, TextureCompressor::Format::RGBA8);
+            Result.Info.Free();
+            Result.Info.Data = nullptr;
+        }
+        Result.DecodeTime = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::steady_clock::now() - StartTime).count();
+        if (Result.Info.Data == nullptr && Result.CompressedInfo.Data.empty())
+        {
+            printf("Failed to open texture: %s\n", filePath.c_str());
+        }
+        return Result;
+    }
+    bool TextureManager::Upload(DecodeResult *decodeResult)
+    {
+        if (decodeResult->IsStreamed)
+        {
+            return UploadStreamed(decodeResult);
+        }
+        Texture &CurrentTexture = mTextureList[decodeResult->TextureHandle];
+        mDecodeCount++;
+        mDecodeTime += decodeResult->DecodeTime;
+        if (decodeResult->CompressedFile != nullptr)
+        {
+            // 所有mip级别直接拷贝，不需要生成mip
+            const TextureCompressor::CompressedImage &Info = decodeResult->CompressedInfo;
+            const TextureCompressor::MipLevel &LastLevel = Info.MipLevelList.back();
+            uint64_t ImageBytes = LastLevel.Offset + LastLevel.Size;
+            mDecodeBytes += ImageBytes;
+            CurrentTexture.Image = ShaderImage::New(mDevice, Info.Width, Info.Height, Image::GetCompressedFormat(Info.ImageFormat), Info.MipLevelList.size(), false);
+            bool IsWrite = CurrentTexture.Image->AllWriteCompressedData(decodeResult->CompressedData, Info.MipLevelList);
+            decodeResult->CompressedFile = nullptr;
+            if (!IsWrite)
+            {
+                CurrentTexture.Image = nullptr;
+                CurrentTexture.TextureState = State::Failed;
+                return false;
+            }
+            mBatchUploadBytes += ImageBytes;
+            mTextureMemory += ImageBytes;
+            mCompressedCount++;
+            return true;
+        }
+        if (decodeResult->Info.Data == nullptr)
+        {
+            CurrentTexture.TextureState = State::Failed;
+            return false;
+        }
+        uint64_t ImageBytes = static_cast<uint64_t>(decodeResult->Info.Width) * decodeResult->Info.Height * 4;
+        mDecodeBytes += ImageBytes;
+        // 传输记录到调用方的上传批次
+        CurrentTexture.Image = ShaderImage::New(mDevice, decodeResult->Info.Width, decodeResult->Info.Height, false);
+        bool IsWrite = CurrentTexture.Image->AllWriteData(decodeResult->Info.Data);
+        decodeResult->Info.Free();
+        if (!IsWrite)
+        {
+            CurrentTexture.Image = nullptr;
+            CurrentTexture.TextureState = State::Failed;
+            return false;
+        }
+        mBatchUploadBytes += ImageBytes;
+        // 完整mip链约为原图的4/3
+        mTextureMemory += ImageBytes * 4 / 3;
+        return true;
+    }
+    bool TextureManager::UploadStreamed(DecodeResult *decodeResult)
+    {
+        Texture &CurrentTexture = mTextureList[decodeResult->TextureHandle];
+        mDecodeCount++;
+        mDecodeTime += decodeResult->DecodeTime;
+        if (decodeResult->CompressedFile == nullptr && decodeResult->CompressedInfo.Data.empty())
+        {
+            CurrentTexture.TextureState = State::Failed;
+            return false;
+        }
+        // 保留完整的mip链，烘焙纹理保留文件映射
+        CurrentTexture.IsStreamed = true;
+        CurrentTexture.ImageFormat = decodeResult->CompressedInfo.ImageFormat;
+        CurrentTexture.MipLevelList = decodeResult->CompressedInfo.MipLevelList;
+        if (decodeResult->CompressedFile != nullptr)
+        {
+            CurrentTexture.File = decodeResult->CompressedFile;
+            CurrentTexture.Data = decodeResult->CompressedData;
+            decodeResult->CompressedFile = nullptr;
+            mCompressedCount++;
+        }
+        else
+        {
+            CurrentTexture.LevelData = std::move(decodeResult->CompressedInfo.Data);
+            CurrentTexture.Data = CurrentTexture.LevelData.data();
+        }
+        mDecodeBytes += GetLevelMemory(CurrentTexture, 0);
+        // 首次只上传mip尾，需要的级别由之后的反馈决定
+        CurrentTexture.TailLevel = CurrentTexture.MipLevelList.size() - 1;
+        for (size_t i = 0; i < CurrentTexture.MipLevelList.size(); i++)
+        {
+            if (std::max(CurrentTexture.MipLevelList[i].Width, CurrentTexture.MipLevelList[i].Height) <= mTailSize)
+            {
+                CurrentTexture.TailLevel = i;
+                break;
+            }
+        }
+        CurrentTexture.ResidentLevel = CurrentTexture.TailLevel;
+        CurrentTexture.DesiredLevel = CurrentTexture.TailLevel;
+        CurrentTexture.Image = CreateLevelImage(CurrentTexture, CurrentTexture.ResidentLevel);
+        if (CurrentTexture.Image == nullptr)
+        {
+            CurrentTexture.TextureState = State::Failed;
+            return false;
+        }
+        mStreamingMemory += GetLevelMemory(CurrentTexture, CurrentTexture.ResidentLevel);
+        return true;
+    }
+    ShaderImage::Ptr TextureManager::CreateLevelImage(Texture &texture, uint32_t baseLevel)
+    {
+        // 级别偏移改为相对baseLevel，数据从baseLevel开始整段写入暂存内存
+        std::vector<TextureCompressor::MipLevel> LevelList(texture.MipLevelList.begin() + baseLevel, texture.MipLevelList.end());
+        uint64_t BaseOffset = LevelList[0].Offset;
+        for (auto &&i : LevelList)
+        {
+            i.Offset -= BaseOffset;
+        }
+        ShaderImage::Ptr LevelImage = ShaderImage::New(mDevice, LevelList[0].Width, LevelList[0].Height, Image::GetCompressedFormat(texture.ImageFormat), LevelList.size(), false);
+        bool IsWrite = LevelImage->AllWriteCompressedData(texture.Data + BaseOffset, LevelList);
+        if (!IsWrite)
+        {
+            return nullptr;
+        }
+        mBatchUploadBytes += GetLevelMemory(texture, baseLevel);
+        return LevelImage;
+    }
+    uint64_t TextureManager::GetLevelMemory(const Texture &texture, uint32_t baseLevel)
+    {
+        if (baseLevel >= texture.MipLevelList.size())
+        {
+            return 0;
+        }
+        const TextureCompressor::MipLevel &LastLevel = texture.MipLevelList.back();
+        return LastLevel.Offset + LastLevel.Size - texture.MipLevelList[baseLevel].Offset;
+    }
+    void TextureManager::UpdateResidency()
+    {
+        // 换入换出完成后替换图像，旧图像在所有帧的描述符都更新后释放
+        for (auto &&i : mTextureList)
+        {
+            if (i.PendingImage == nullptr || i.PendingTicket == 0 || !mDevice->GetUploader()->IsComplete(i.PendingTicket))
+            {
+                continue;
+            }
+            mRetiredImageList.push_back({i.Image, GetLevelMemory(i, i.ResidentLevel), mFrameNumber + mDevice->GetFrameInFlightCount()});
+            i.Image = i.PendingImage;
+            i.ResidentLevel = i.PendingLevel;
+            i.PendingImage = nullptr;
+            i.PendingTicket = 0;
+            i.Version++;
+        }
+        for (auto Iterator = mRetiredImageList.begin(); Iterator != mRetiredImageList.end();)
+        {
+            if (Iterator->ReleaseFrame <= mFrameNumber)
+            {
+                mStreamingMemory -= Iterator->Memory;
+                Iterator = mRetiredImageList.erase(Iterator);
+            }
+            else
+            {
+                Iterator++;
+            }
+        }
+    }
+    void TextureManager::PlanStreaming(std::vector<std::pair<Handle, uint32_t>> *changeList)
+    {
+        // 目标级别取需要的级别，不主动换出已常驻的级别，正在上传的纹理保持上传的级别
+        std::vector<Handle> StreamedList;
+        std::vector<uint32_t> TargetList(mTextureList.size(), 0);
+        uint64_t PlannedMemory = 0;
+        for (Handle i = 0; i < mTextureList.size(); i++)
+        {
+            const Texture &CurrentTexture = mTextureList[i];
+            if (!CurrentTexture.IsStreamed || CurrentTexture.TextureState != State::Ready)
+            {
+                continue;
+            }
+            TargetList[i] = CurrentTexture.PendingImage != nullptr ? CurrentTexture.PendingLevel : std::min(CurrentTexture.DesiredLevel, CurrentTexture.ResidentLevel);
+            PlannedMemory += GetLevelMemory(CurrentTexture, TargetList[i]);
+            StreamedList.push_back(i);
+        }
+        // 超出预算时逐级淘汰，先淘汰最久未可见的纹理，同时可见时先淘汰最精细级别最大的纹理
+        while (PlannedMemory > mStreamingBudget)
+        {
+            Handle EvictHandle = mInvalidHandle;
+            for (auto &&i : StreamedList)
+            {
+                const Texture &CurrentTexture = mTextureList[i];
+                if (CurrentTexture.PendingImage != nullptr || TargetList[i] >= CurrentTexture.TailLevel)
+                {
+                    continue;
+                }
+                if (EvictHandle == mInvalidHandle)
+                {
+                    EvictHandle = i;
+                    continue;
+                }
+                const Texture &EvictTexture = mTextureList[EvictHandle];
+                if (CurrentTexture.LastVisibleFrame < EvictTexture.LastVisibleFrame ||
+                    (CurrentTexture.LastVisibleFrame == EvictTexture.LastVisibleFrame &&
+                     CurrentTexture.MipLevelList[TargetList[i]].Size > EvictTexture.MipLevelList[TargetList[EvictHandle]].Size))
+                {
+                    EvictHandle = i;
+                }
+            }
+            if (EvictHandle == mInvalidHandle)
+            {
+                break;
+            }
+            PlannedMemory -= mTextureList[EvictHandle].MipLevelList[TargetList[EvictHandle]].Size;
+            TargetList[EvictHandle]++;
+        }
+        // 换出全部提交，换入先提交最近可见的纹理，每帧换入的字节数有上限
+        std::vector<Handle> StreamInList;
+        for (auto &&i : StreamedList)
+        {
+            const Texture &CurrentTexture = mTextureList[i];
+            if (CurrentTexture.PendingImage != nullptr || TargetList[i] == CurrentTexture.ResidentLevel)
+            {
+                continue;
+            }
+            if (TargetList[i] > CurrentTexture.ResidentLevel)
+            {
+                changeList->push_back({i, TargetList[i]});
+            }
+            else
+            {
+                StreamInList.push_back(i);
+            }
+        }
+        std::sort(StreamInList.begin(), StreamInList.end(), [this](Handle a, Handle b)
+                  { return mTextureList[a].LastVisibleFrame > mTextureList[b].LastVisibleFrame; });
+        uint64_t StreamInBytes = 0;
+        for (auto &&i : StreamInList)
+        {
+            uint64_t LevelMemory = GetLevelMemory(mTextureList[i], TargetList[i]);
+            if (StreamInBytes > 0 && StreamInBytes + LevelMemory > mStreamingBytesPerFrame)
+            {
+                continue;
+            }
+            StreamInBytes += LevelMemory;
+            changeList->push_back({i, TargetList[i]});
+        }
+    }
+
+    TextureManager::Handle TextureManager::Register(std::string filePath)
+    {
+        auto Iterator = mPathMap.find(filePath);
+        if (Iterator != mPathMap.end())
+        {
+            return Iterator->second;
+        }
+        Handle TextureHandle = mTextureList.size();
+        Texture NewTexture{};
+        NewTexture.FilePath = filePath;
+        NewTexture.Name = GetFileName(filePath);
+        mTextureList.push_back(NewTexture);
+        mPathMap[filePath] = TextureHandle;
+        // 同名时保留先注册的纹理
+        mNameMap.insert({NewTexture.Name, TextureHandle});
+        return TextureHandle;
+    }
+    TextureManager::Handle TextureManager::Find(std::string name)
+    {
+        auto Iterator = mNameMap.find(name);
+        if (Iterator == mNameMap.end())
+        {
+            return mInvalidHandle;
+        }
+        return Iterator->second;
+    }
+    ShaderImage::Ptr TextureManager::Get(Handle handle)
+    {
+        if (handle >= mTextureList.size())
+        {
+            return nullptr;
+        }
+        Texture &CurrentTexture = mTextureList[handle];
+        if (CurrentTexture.TextureState == State::Unloaded)
+        {
+            // 同步加载，上传在调用方的批次中完成后即可使用
+            DecodeResult Result = Decode(handle, CurrentTexture.FilePath, mDevice->IsTextureCompressionBCSupported(), false);
+            if (Upload(&Result))
+            {
+                CurrentTexture.TextureState = State::Ready;
+            }
+        }
+        return CurrentTexture.TextureState == State::Ready ? CurrentTexture.Image : nullptr;
+    }
+    void TextureManager::Request(Handle handle)
+    {
+        if (handle >= mTextureList.size() || mTextureList[handle].TextureState != State::Unloaded)
+        {
+            return;
+        }
+        mTextureList[handle].TextureState = State::Decoding;
+        mDecodeJobSystem->Run([this, handle, FilePath = mTextureList[handle].FilePath, IsCompressedSupported = mDevice->IsTextureCompressionBCSupported()]()
+                              {
+                                  DecodeResult Result = Decode(handle, FilePath, IsCompressedSupported, true);
+                                  std::lock_guard<std::mutex> Lock(mDecodeMutex);
+                                  mDecodeResultList.push_back(std::move(Result)); },
+                              &mDecodeCounter);
+        //
+    }
+    void TextureManager::Update()
+    {
+        Uploader::Ptr TextureUploader = mDevice->GetUploader();
+        // 回收已完成的上传批次，完成换入换出
+        TextureUploader->Collect();
+        UpdateResidency();
+        // 上传耗时从开始写入暂存内存到批次完成，批次按顺序完成，与上一批次重叠的部分不重复计算
+        std::chrono::steady_clock::time_point CurrentTime = std::chrono::steady_clock::now();
+        while (!mUploadBatchList.empty() && TextureUploader->IsComplete(mUploadBatchList.front().Ticket))
+        {
+            std::chrono::steady_clock::time_point StartTime = std::max(mUploadBatchList.front().StartTime, mLastUploadCompleteTime);
+            mUploadTime += std::chrono::duration<float, std::chrono::milliseconds::period>(CurrentTime - StartTime).count();
+            mUploadBytes += mUploadBatchList.front().Bytes;
+            mLastUploadCompleteTime = CurrentTime;
+            mUploadBatchList.pop_front();
+        }
+
+        // 取出已解码的结果，与本帧的换入换出在一个批次中提交
+        std::vector<DecodeResult> ResultList;
+        {
+            std::lock_guard<std::mutex> Lock(mDecodeMutex);
+            ResultList.swap(mDecodeResultList);
+        }
+        std::vector<std::pair<Handle, uint32_t>> ChangeList;
+        PlanStreaming(&ChangeList);
+        if (!ResultList.empty() || !ChangeList.empty())
+        {
+            std::chrono::steady_clock::time_point BatchStartTime = std::chrono::steady_clock::now();
+            mBatchUploadBytes = 0;
+            TextureUploader->Begin();
+            std::vector<Handle> UploadList;
+            for (auto &&i : ResultList)
+            {
+                if (Upload(&i))
+                {
+                    UploadList.push_back(i.TextureHandle);
+                }
+            }
+            std::vector<Handle> StreamList;
+            for (auto &&i : ChangeList)
+            {
+                Texture &CurrentTexture = mTextureList[i.first];
+                CurrentTexture.PendingImage = CreateLevelImage(CurrentTexture, i.second);
+                if (CurrentTexture.PendingImage == nullptr)
+                {
+                    continue;
+                }
+                CurrentTexture.PendingLevel = i.second;
+                uint64_t LevelMemory = GetLevelMemory(CurrentTexture, i.second);
+                mStreamingMemory += LevelMemory;
+                if (i.second < CurrentTexture.ResidentLevel)
+                {
+                    mStreamInCount++;
+                    mStreamInBytes += LevelMemory;
+                }
+                else
+                {
+                    mStreamOutCount++;
+                }
+                StreamList.push_back(i.first);
+            }
+            uint64_t UploadTicket = 0;
+            TextureUploader->End(&UploadTicket);
+            mUploadBatchList.push_back({UploadTicket, mBatchUploadBytes, BatchStartTime});
+            for (auto &&i : UploadList)
+            {
+                mTextureList[i].TextureState = State::Uploading;
+                mTextureList[i].UploadTicket = UploadTicket;
+                mUploadingList.push_back(i);
+            }
+            for (auto &&i : StreamList)
+            {
+                mTextureList[i].PendingTicket = UploadTicket;
+            }
+        }
+        // 上传完成的纹理变为就绪
+        for (auto Iterator = mUploadingList.begin(); Iterator != mUploadingList.end();)
+        {
+            Texture &CurrentTexture = mTextureList[*Iterator];
+            if (TextureUploader->IsComplete(CurrentTexture.UploadTicket))
+            {
+                CurrentTexture.TextureState = State::Ready;
+                CurrentTexture.Version++;
+                Iterator = mUploadingList.erase(Iterator);
+            }
+            else
+            {
+                Iterator++;
+            }
+        }
+        mFrameNumber++;
+    }
+    void TextureManager::ReportFeedback(Handle handle, uint32_t level)
+    {
+        if (handle >= mTextureList.size() || !mTextureList[handle].IsStreamed)
+        {
+            return;
+        }
+        // 同一帧中多处使用同一纹理时取最精细的级别
+        Texture &CurrentTexture = mTextureList[handle];
+        level = std::min<uint32_t>(level, CurrentTexture.MipLevelList.size() - 1);
+        CurrentTexture.DesiredLevel = CurrentTexture.LastVisibleFrame == mFrameNumber ? std::min(CurrentTexture.DesiredLevel, level) : level;
+        CurrentTexture.LastVisibleFrame = mFrameNumber;
+    }
+    uint32_t TextureManager::GetPendingCount()
+    {
+        uint32_t PendingCount = 0;
+        for (auto &&i : mTextureList)
+        {
+            if (i.TextureState == State::Decoding || i.TextureState == State::Uploading)
+            {
+                PendingCount++;
+            }
+        }
+        return PendingCount;
+    }
+} // namespace vk
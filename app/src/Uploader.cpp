@@ -0,0 +1,397 @@
+#include "vk/Uploader.h"
+#include "vk/Device.h"
+
+namespace vk
+{
+    Uploader::Uploader(Device *device, VkDeviceSize stagingPageSize)
+        : mDevice(device), mStagingPageSize(stagingPageSize)
+    {
+        CreateCommandPool();
+    }
+    Uploader::~Uploader()
+    {
+        WaitAll();
+        // 未提交的批次
+        if (mRecordingBatch != nullptr)
+        {
+            vkEndCommandBuffer(mRecordingBatch->CommandBuffer);
+            if (mRecordingBatch->IsTransferRecording)
+            {
+                vkEndCommandBuffer(mRecordingBatch->TransferCommandBuffer);
+            }
+            RecycleBatch(std::move(mRecordingBatch));
+        }
+        // 批次
+        for (auto &&i : mIdleBatchList)
+        {
+            if (i->Fence != nullptr)
+            {
+                vkDestroyFence(mDevice->GetLogicalDevice(), i->Fence, nullptr);
+            }
+            if (i->TransferSemaphore != nullptr)
+            {
+                vkDestroySemaphore(mDevice->GetLogicalDevice(), i->TransferSemaphore, nullptr);
+            }
+        }
+        // 暂存内存页
+        for (auto &&i : mIdleStagingPageList)
+        {
+            DestroyStagingPage(&i);
+        }
+        // 命令池
+        if (mTransferCommandPool != nullptr)
+        {
+            vkDestroyCommandPool(mDevice->GetLogicalDevice(), mTransferCommandPool, nullptr);
+        }
+        if (mCommandPool != nullptr)
+        {
+            vkDestroyCommandPool(mDevice->GetLogicalDevice(), mCommandPool, nullptr);
+        }
+    }
+
+    void Uploader::CreateCommandPool()
+    {
+        VkCommandPoolCreateInfo CommandPoolCreateInfo{};
+        CommandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        CommandPoolCreateInfo.queueFamilyIndex = mDevice->GetGraphicsQueueFamilyIndex();
+        CommandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        if (vkCreateCommandPool(mDevice->GetLogicalDevice(), &CommandPoolCreateInfo, nullptr, &mCommandPool) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to create upload command pool!");
+        }
+        // 传输队列命令池
+        if (mDevice->IsHaveDedicatedTransferQueue())
+        {
+            CommandPoolCreateInfo.queueFamilyIndex = mDevice->GetTransferQueueFamilyIndex();
+            if (vkCreateCommandPool(mDevice->GetLogicalDevice(), &CommandPoolCreateInfo, nullptr, &mTransferCommandPool) != VK_SUCCESS)
+            {
+                throw std::runtime_error("Failed to create transfer command pool!");
+            }
+        }
+    }
+    bool Uploader::StartBatch()
+    {
+        Collect();
+        // 优先复用已完成的批次
+        std::unique_ptr<Batch> NewBatch;
+        if (!mIdleBatchList.empty())
+        {
+            NewBatch = std::move(mIdleBatchList.back());
+            mIdleBatchList.pop_back();
+        }
+        else
+        {
+            NewBatch = std::make_unique<Batch>();
+            VkCommandBufferAllocateInfo CommandBufferAllocateInfo{};
+            CommandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            CommandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            CommandBufferAllocateInfo.commandPool = mCommandPool;
+            CommandBufferAllocateInfo.commandBufferCount = 1;
+            if (vkAllocateCommandBuffers(mDevice->GetLogicalDevice(), &CommandBufferAllocateInfo, &NewBatch->CommandBuffer) != VK_SUCCESS)
+            {
+                return false;
+            }
+            VkFenceCreateInfo FenceCreateInfo{};
+            FenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+            if (vkCreateFence(mDevice->GetLogicalDevice(), &FenceCreateInfo, nullptr, &NewBatch->Fence) != VK_SUCCESS)
+            {
+                vkFreeCommandBuffers(mDevice->GetLogicalDevice(), mCommandPool, 1, &NewBatch->CommandBuffer);
+                return false;
+            }
+            // 传输队列命令缓冲区与信号
+            if (mTransferCommandPool != nullptr)
+            {
+                CommandBufferAllocateInfo.commandPool = mTransferCommandPool;
+                VkSemaphoreCreateInfo SemaphoreCreateInfo{};
+                SemaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+                if (vkAllocateCommandBuffers(mDevice->GetLogicalDevice(), &CommandBufferAllocateInfo, &NewBatch->TransferCommandBuffer) != VK_SUCCESS ||
+                    vkCreateSemaphore(mDevice->GetLogicalDevice(), &SemaphoreCreateInfo, nullptr, &NewBatch->TransferSemaphore) != VK_SUCCESS)
+                {
+                    mIdleBatchList.push_back(std::move(NewBatch));
+                    return false;
+                }
+            }
+        }
+
+        VkCommandBufferBeginInfo CommandBufferBeginInfo{};
+        CommandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        CommandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        if (vkBeginCommandBuffer(NewBatch->CommandBuffer, &CommandBufferBeginInfo) != VK_SUCCESS)
+        {
+            mIdleBatchList.push_back(std::move(NewBatch));
+            return false;
+        }
+        NewBatch->Ticket = mNextTicket++;
+        mRecordingBatch = std::move(NewBatch);
+        return true;
+    }
+    bool Uploader::CreateStagingPage(VkDeviceSize size, StagingPage *stagingPage)
+    {
+        stagingPage->Size = size;
+        stagingPage->Used = 0;
+        if (!mDevice->CreateBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                   &stagingPage->Buffer, &stagingPage->Memory))
+        {
+            DestroyStagingPage(stagingPage);
+            return false;
+        }
+        return true;
+    }
+    void Uploader::DestroyStagingPage(StagingPage *stagingPage)
+    {
+        if (stagingPage->Buffer != nullptr)
+        {
+            vkDestroyBuffer(mDevice->GetLogicalDevice(), stagingPage->Buffer, nullptr);
+            stagingPage->Buffer = nullptr;
+        }
+        mDevice->FreeMemory(&stagingPage->Memory);
+    }
+    void Uploader::RecycleBatch(std::unique_ptr<Batch> batch)
+    {
+        vkResetFences(mDevice->GetLogicalDevice(), 1, &batch->Fence);
+        vkResetCommandBuffer(batch->CommandBuffer, 0);
+        if (batch->TransferCommandBuffer != nullptr)
+        {
+            vkResetCommandBuffer(batch->TransferCommandBuffer, 0);
+        }
+        batch->IsTransferRecording = false;
+        // 回收暂存内存页，超出常规大小或空闲过多的页直接释放
+        for (auto &&i : batch->StagingPageList)
+        {
+            if (i.Size > mStagingPageSize || mIdleStagingPageList.size() >= 4)
+            {
+                DestroyStagingPage(&i);
+                continue;
+            }
+            i.Used = 0;
+            mIdleStagingPageList.push_back(i);
+        }
+        batch->StagingPageList.clear();
+        mIdleBatchList.push_back(std::move(batch));
+    }
+
+    bool Uploader::Begin()
+    {
+        if (mRecordingBatch == nullptr && !StartBatch())
+        {
+            return false;
+        }
+        mRecordingDepth++;
+        return true;
+    }
+    bool Uploader::End(uint64_t *ticket)
+    {
+        *ticket = 0;
+        if (mRecordingDepth == 0 || mRecordingBatch == nullptr)
+        {
+            return false;
+        }
+        mRecordingDepth--;
+        if (mRecordingDepth > 0)
+        {
+            return true;
+        }
+
+        // 最外层结束，传输写入对后续的顶点、索引与着色器读取可见
+        VkMemoryBarrier MemoryBarrier{};
+        MemoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        MemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        MemoryBarrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(mRecordingBatch->CommandBuffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+                             1, &MemoryBarrier,
+                             0, nullptr,
+                             0, nullptr);
+        //
+
+        // 先提交传输队列命令，完成后触发信号
+        bool IsHaveTransfer = mRecordingBatch->IsTransferRecording;
+        if (IsHaveTransfer)
+        {
+            if (vkEndCommandBuffer(mRecordingBatch->TransferCommandBuffer) != VK_SUCCESS)
+            {
+                return false;
+            }
+            VkSubmitInfo TransferSubmitInfo{};
+            TransferSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            TransferSubmitInfo.commandBufferCount = 1;
+            TransferSubmitInfo.pCommandBuffers = &mRecordingBatch->TransferCommandBuffer;
+            TransferSubmitInfo.signalSemaphoreCount = 1;
+            TransferSubmitInfo.pSignalSemaphores = &mRecordingBatch->TransferSemaphore;
+            if (vkQueueSubmit(mDevice->GetTransferQueue(), 1, &TransferSubmitInfo, nullptr) != VK_SUCCESS)
+            {
+                return false;
+            }
+            mTransferSubmitCount++;
+        }
+
+        // 提交图形队列命令，等待传输完成
+        if (vkEndCommandBuffer(mRecordingBatch->CommandBuffer) != VK_SUCCESS)
+        {
+            return false;
+        }
+        VkPipelineStageFlags WaitStageFlags = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        VkSubmitInfo SubmitInfo{};
+        SubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        SubmitInfo.commandBufferCount = 1;
+        SubmitInfo.pCommandBuffers = &mRecordingBatch->CommandBuffer;
+        if (IsHaveTransfer)
+        {
+            SubmitInfo.waitSemaphoreCount = 1;
+            SubmitInfo.pWaitSemaphores = &mRecordingBatch->TransferSemaphore;
+            SubmitInfo.pWaitDstStageMask = &WaitStageFlags;
+        }
+        if (vkQueueSubmit(mDevice->GetGraphicsQueue(), 1, &SubmitInfo, mRecordingBatch->Fence) != VK_SUCCESS)
+        {
+            return false;
+        }
+        *ticket = mRecordingBatch->Ticket;
+        mSubmitCount++;
+        mSubmittedBatchList.push_back(std::move(mRecordingBatch));
+        return true;
+    }
+    VkCommandBuffer Uploader::GetCommandBuffer()
+    {
+        if (mRecordingBatch == nullptr && !StartBatch())
+        {
+            return nullptr;
+        }
+        return mRecordingBatch->CommandBuffer;
+    }
+    VkCommandBuffer Uploader::GetTransferCommandBuffer()
+    {
+        if (mTransferCommandPool == nullptr)
+        {
+            return GetCommandBuffer();
+        }
+        if (mRecordingBatch == nullptr && !StartBatch())
+        {
+            return nullptr;
+        }
+        if (!mRecordingBatch->IsTransferRecording)
+        {
+            VkCommandBufferBeginInfo CommandBufferBeginInfo{};
+            CommandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            CommandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+            if (vkBeginCommandBuffer(mRecordingBatch->TransferCommandBuffer, &CommandBufferBeginInfo) != VK_SUCCESS)
+            {
+                return nullptr;
+            }
+            mRecordingBatch->IsTransferRecording = true;
+        }
+        return mRecordingBatch->TransferCommandBuffer;
+    }
+    bool Uploader::WriteStaging(const void *data, VkDeviceSize size, StagingRange *stagingRange)
+    {
+        if (mRecordingBatch == nullptr && !StartBatch())
+        {
+            return false;
+        }
+        // 偏移按16字节对齐，满足缓冲区到图像拷贝（包括压缩格式）的对齐要求
+        std::vector<StagingPage> &StagingPageList = mRecordingBatch->StagingPageList;
+        StagingPage *pStagingPage = nullptr;
+        if (!StagingPageList.empty())
+        {
+            StagingPage &LastPage = StagingPageList.back();
+            VkDeviceSize Offset = (LastPage.Used + 15) & ~VkDeviceSize(15);
+            if (Offset + size <= LastPage.Size)
+            {
+                LastPage.Used = Offset;
+                pStagingPage = &LastPage;
+            }
+        }
+        if (pStagingPage == nullptr)
+        {
+            // 从空闲页中查找足够大的页，没有则新建
+            StagingPage NewPage{};
+            bool IsFound = false;
+            for (auto i = mIdleStagingPageList.begin(); i != mIdleStagingPageList.end(); i++)
+            {
+                if (i->Size >= size)
+                {
+                    NewPage = *i;
+                    mIdleStagingPageList.erase(i);
+                    IsFound = true;
+                    break;
+                }
+            }
+            if (!IsFound && !CreateStagingPage(std::max(size, mStagingPageSize), &NewPage))
+            {
+                return false;
+            }
+            StagingPageList.push_back(NewPage);
+            pStagingPage = &StagingPageList.back();
+        }
+
+        stagingRange->Buffer = pStagingPage->Buffer;
+        stagingRange->Offset = pStagingPage->Used;
+        stagingRange->MappedData = static_cast<char *>(pStagingPage->Memory.MappedData) + pStagingPage->Used;
+        if (data != nullptr)
+        {
+            memcpy(stagingRange->MappedData, data, size);
+        }
+        pStagingPage->Used += size;
+        mStagingBytes += size;
+        return true;
+    }
+
+    bool Uploader::Wait(uint64_t ticket)
+    {
+        for (auto &&i : mSubmittedBatchList)
+        {
+            if (i->Ticket == ticket)
+            {
+                if (vkWaitForFences(mDevice->GetLogicalDevice(), 1, &i->Fence, VK_TRUE, UINT64_MAX) != VK_SUCCESS)
+                {
+                    return false;
+                }
+                break;
+            }
+        }
+        Collect();
+        return IsComplete(ticket);
+    }
+    bool Uploader::WaitAll()
+    {
+        for (auto &&i : mSubmittedBatchList)
+        {
+            if (vkWaitForFences(mDevice->GetLogicalDevice(), 1, &i->Fence, VK_TRUE, UINT64_MAX) != VK_SUCCESS)
+            {
+                return false;
+            }
+        }
+        Collect();
+        return true;
+    }
+    bool Uploader::IsComplete(uint64_t ticket)
+    {
+        if (mRecordingBatch != nullptr && mRecordingBatch->Ticket == ticket)
+        {
+            return false;
+        }
+        for (auto &&i : mSubmittedBatchList)
+        {
+            if (i->Ticket == ticket)
+            {
+                return false;
+            }
+        }
+        return ticket < mNextTicket;
+    }
+    void Uploader::Collect()
+    {
+        for (auto i = mSubmittedBatchList.begin(); i != mSubmittedBatchList.end();)
+        {
+            if (vkGetFenceStatus(mDevice->GetLogicalDevice(), (*i)->Fence) == VK_SUCCESS)
+            {
+                RecycleBatch(std::move(*i));
+                i = mSubmittedBatchList.erase(i);
+            }
+            else
+            {
+                i++;
+            }
+        }
+    }
+} // namespace vk
@@ -1,11 +1,18 @@
 #include "App.h"
 
 #include <iostream>
+#include <cstring>
 
 int main(int argc, char *argv[])
 {
     try
     {
+        // 任务系统吞吐量测试
+        if (argc > 1 && strcmp(argv[1], "--job-benchmark") == 0)
+        {
+            vk::JobSystem::Benchmark(argc > 2 ? std::stoul(argv[2]) : 1000000);
+            return EXIT_SUCCESS;
+        }
         App().run();
     }
     catch (const std::exception &e)
@@ -25,7 +25,7 @@ namespace vk
         // 缓冲区
         size_t mBufferSize = 0;
         VkBuffer mBuffer = nullptr;
-        VkDeviceMemory mMemory = nullptr;
+        MemoryAllocator::Allocation mMemory{};
 
     private:
         void CreateBuffer(VkBufferUsageFlags usage, VkMemoryPropertyFlags properties);
@@ -34,9 +34,13 @@ namespace vk
         bool WriteBuffer(Buffer::Ptr buffer);
         bool WriteHostData(void *data);
         bool WriteData(void *data);
+        // 写入缓冲区中的一段
+        bool WriteData(void *data, VkDeviceSize offset, VkDeviceSize size);
 
         VkBuffer GetBuffer() { return mBuffer; }
-        VkDeviceMemory GetMemory() { return mMemory; }
+        VkDeviceMemory GetMemory() { return mMemory.Memory; }
+        VkDeviceSize GetMemoryOffset() { return mMemory.Offset; }
+        void *GetMappedData() { return mMemory.MappedData; }
         size_t GetBufferSize() { return mBufferSize; }
     };
 } // namespace vk
@@ -26,15 +26,26 @@ namespace vk
         glm::mat4 mProjectionMat{};
         glm::mat4 mViewMat{};
         glm::mat4 mInverseViewMat{};
+        // 投影参数
+        float mFocalLength = 0.0f;
+        float mProximalPoint = 0.0f;
+        float mFarPoint = 0.0f;
+        VkExtent2D mExtent{};
+
+    private:
+        void UpdateProjectionMat();
 
     public:
         void Transform(Device::Ptr device, float yaw, float pitch, float x, float y, float z, float focalLength, float proximalPoint, float farPoint);
         void InputTick();
+        // 画面尺寸变化时重新计算投影矩阵
+        void Resize(VkExtent2D extent);
 
         glm::mat4 GetProjectionMat() { return mProjectionMat; }
         glm::mat4 GetViewMat() { return mViewMat; }
         glm::mat4 GetInverseViewMat() { return mInverseViewMat; }
         glm::vec2 GetView() { return glm::vec2(mYaw, mPitch); }
         glm::vec3 GetPosition() { return mCameraPos; }
+        float GetFarPoint() { return mFarPoint; }
     };
 } // namespace vk
@@ -0,0 +1,32 @@
+#pragma once
+#include "Origin.h"
+#include "Device.h"
+#include "DescriptorSetLayout.h"
+#include "ShaderModule.h"
+
+namespace vk
+{
+    class ComputePipeline
+    {
+    public:
+        ComputePipeline(Device::Ptr device, DescriptorSetLayout::Ptr descriptorSet, ShaderModule::Ptr shaderModule);
+        ~ComputePipeline();
+
+        using Ptr = std::shared_ptr<ComputePipeline>;
+        static Ptr New(Device::Ptr device, DescriptorSetLayout::Ptr descriptorSet, ShaderModule::Ptr shaderModule)
+        {
+            return std::make_shared<ComputePipeline>(device, descriptorSet, shaderModule);
+        }
+
+    private:
+        Device::Ptr mDevice;
+        // 计算管线
+        VkPipeline mPipeline = nullptr;
+
+    private:
+        void CreatePipeline(DescriptorSetLayout::Ptr descriptorSet, ShaderModule::Ptr shaderModule);
+
+    public:
+        VkPipeline GetPipeline() { return mPipeline; }
+    };
+} // namespace vk
@@ -0,0 +1,18 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace vk
+{
+    /**
+     * @brief 文件内容哈希
+     * 网格缓存与烘焙纹理用来判断源文件是否改变，两者必须使用同一算法
+     * 只依赖标准库，离线烘焙工具直接编译此文件
+     */
+    class ContentHash
+    {
+    public:
+        // FNV-1a，长度同样参与哈希，结果不为0，0留给读取失败
+        static uint64_t Hash(const uint8_t *data, size_t size);
+    };
+} // namespace vk
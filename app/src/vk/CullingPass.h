@@ -0,0 +1,80 @@
+#pragma once
+#include "Origin.h"
+#include "Device.h"
+#include "Buffer.h"
+#include "DescriptorSetLayout.h"
+#include "DescriptorSet.h"
+#include "ComputePipeline.h"
+
+namespace vk
+{
+    /**
+     * @brief 剔除通道
+     * 计算着色器使用相机视锥体测试每个绘制的包围球，可见的绘制压缩写入间接绘制缓冲区并统计数量
+     * 设备不支持间接绘制数量时，绘制保留在原位置，不可见的绘制实例数设为0
+     */
+    class CullingPass
+    {
+    public:
+        CullingPass(Device::Ptr device, std::vector<VkDrawIndexedIndirectCommand> drawCommandList, std::vector<glm::vec4> boundingSphereList);
+        ~CullingPass();
+
+        using Ptr = std::shared_ptr<CullingPass>;
+        // 包围球为世界空间，xyz为球心，w为半径，与绘制参数一一对应
+        static Ptr New(Device::Ptr device, std::vector<VkDrawIndexedIndirectCommand> drawCommandList, std::vector<glm::vec4> boundingSphereList)
+        {
+            return std::make_shared<CullingPass>(device, drawCommandList, boundingSphereList);
+        }
+
+    private:
+        // 推送常量
+        struct CullLayout
+        {
+            uint32_t DrawCount;
+            uint32_t IsCompact;
+            uint32_t IsCullEnable;
+        };
+
+    private:
+        Device::Ptr mDevice;
+        // 描述符与计算管线
+        DescriptorSetLayout::Ptr mDescriptorSetLayout;
+        DescriptorSet::Ptr mDescriptorSet;
+        ComputePipeline::Ptr mPipeline;
+        // 输入的绘制参数与包围球
+        Buffer::Ptr mInputDrawBuffer;
+        Buffer::Ptr mBoundingSphereBuffer;
+        // 输出的绘制参数与可见数量，按同时处理的帧数创建
+        std::vector<Buffer::Ptr> mOutputDrawBufferList;
+        std::vector<Buffer::Ptr> mDrawCountBufferList;
+        uint32_t mDrawCount = 0;
+        bool mIsCompact = false;
+        bool mIsCullEnable = true;
+        uint32_t mVisibleCount = 0;
+
+    private:
+        void CreateDescriptorSet();
+        // 着色器无法加载时返回false
+        bool CreatePipeline();
+        void CreateBuffer(const std::vector<VkDrawIndexedIndirectCommand> &drawCommandList, const std::vector<glm::vec4> &boundingSphereList);
+        void WriteDescriptorSet();
+
+    public:
+        // 相机空间缓冲区由使用者写入绑定10
+        DescriptorSet::Ptr GetDescriptorSet() { return mDescriptorSet; }
+        // 计算管线创建失败时不可用，使用者回退到CPU剔除
+        bool IsValid() { return mPipeline != nullptr; }
+        // 在渲染流程开始前录制剔除命令
+        void Record(VkCommandBuffer commandBuffer, uint32_t currentIndex);
+
+        Buffer::Ptr GetDrawBuffer(uint32_t currentIndex) { return mOutputDrawBufferList[currentIndex]; }
+        Buffer::Ptr GetDrawCountBuffer(uint32_t currentIndex) { return mDrawCountBufferList[currentIndex]; }
+        uint32_t GetDrawCount() { return mDrawCount; }
+        // 可见的绘制是否压缩排列，此时需要通过间接绘制数量绘制
+        bool IsCompact() { return mIsCompact; }
+        void SetCullEnable(bool isCullEnable) { mIsCullEnable = isCullEnable; }
+        bool IsCullEnable() { return mIsCullEnable; }
+        // 上一次使用同一帧资源时的可见数量
+        uint32_t GetVisibleCount() { return mVisibleCount; }
+    };
+} // namespace vk
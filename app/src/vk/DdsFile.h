@@ -0,0 +1,74 @@
+#pragma once
+#include "TextureCompressor.h"
+#include "ContentHash.h"
+
+namespace vk
+{
+    /**
+     * @brief DDS纹理文件
+     * 写入时使用DX10扩展头，格式为BC1、BC3或RGBA8的sRGB版本，所有mip级别紧跟在文件头之后
+     * 读取时同时接受旧式的DXT1与DXT5，按sRGB颜色纹理处理
+     * 烘焙时源文件的哈希写入文件头的保留字段，源文件修改后烘焙文件失效
+     */
+    class DdsFile
+    {
+    private:
+        struct PixelFormat
+        {
+            uint32_t Size;
+            uint32_t Flags;
+            uint32_t FourCC;
+            uint32_t RGBBitCount;
+            uint32_t RBitMask;
+            uint32_t GBitMask;
+            uint32_t BBitMask;
+            uint32_t ABitMask;
+        };
+        struct Header
+        {
+            uint32_t Size;
+            uint32_t Flags;
+            uint32_t Height;
+            uint32_t Width;
+            uint32_t PitchOrLinearSize;
+            uint32_t Depth;
+            uint32_t MipMapCount;
+            uint32_t Reserved1[11];
+            PixelFormat Format;
+            uint32_t Caps;
+            uint32_t Caps2;
+            uint32_t Caps3;
+            uint32_t Caps4;
+            uint32_t Reserved2;
+        };
+        struct HeaderDX10
+        {
+            uint32_t DxgiFormat;
+            uint32_t ResourceDimension;
+            uint32_t MiscFlag;
+            uint32_t ArraySize;
+            uint32_t MiscFlags2;
+        };
+
+    private:
+        static constexpr uint32_t mMagic = 0x20534444; // "DDS "
+        static constexpr uint32_t mFourCCDXT1 = 0x31545844;
+        static constexpr uint32_t mFourCCDXT5 = 0x35545844;
+        static constexpr uint32_t mFourCCDX10 = 0x30315844;
+        static constexpr uint32_t mDxgiFormatRGBA8 = 28;
+        static constexpr uint32_t mDxgiFormatRGBA8Srgb = 29;
+        static constexpr uint32_t mDxgiFormatBC1 = 71;
+        static constexpr uint32_t mDxgiFormatBC1Srgb = 72;
+        static constexpr uint32_t mDxgiFormatBC3 = 77;
+        static constexpr uint32_t mDxgiFormatBC3Srgb = 78;
+        // 保留字段中源文件哈希的标记
+        static constexpr uint32_t mSourceHashTag = 0x48435253; // SRCH
+
+    public:
+        // 先写入临时文件再替换，sourceHash为源文件内容的哈希，失败时返回false
+        static bool Save(std::string filePath, const TextureCompressor::CompressedImage &image, uint64_t sourceHash);
+        // 解析内存中的文件，不拷贝数据，image的Data为空，levelData指向data中第一个mip级别
+        // sourceHash为烘焙时记录的源文件哈希，由ContentHash计算，没有记录时为0
+        static bool Parse(const uint8_t *data, size_t size, TextureCompressor::CompressedImage *image, const uint8_t **levelData, uint64_t *sourceHash = nullptr);
+    };
+} // namespace vk
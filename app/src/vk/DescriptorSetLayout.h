@@ -26,6 +26,8 @@ namespace vk
         VkDescriptorPool mDescriptorPool = nullptr;
         // 渲染管线布局
         VkPipelineLayout mPipelineLayout = nullptr;
+        // 动态描述符数量，绑定描述符集时需要提供相同数量的动态偏移
+        uint32_t mDynamicDescriptorCount = 0;
 
     private:
         void CreateDescriptorSetLayout(std::vector<VkDescriptorSetLayoutBinding> descriptorSetLayoutBindingList);
@@ -36,5 +38,6 @@ namespace vk
         VkDescriptorSetLayout GetDescriptorSetLayout() { return mDescriptorSetLayout; }
         VkDescriptorPool GetDescriptorPool() { return mDescriptorPool; }
         VkPipelineLayout GetPipelineLayout() { return mPipelineLayout; }
+        uint32_t GetDynamicDescriptorCount() { return mDynamicDescriptorCount; }
     };
 } // namespace vk
@@ -1,19 +1,23 @@
 #pragma once
 #include "Origin.h"
 #include "Window.h"
+#include "MemoryAllocator.h"
+#include "Uploader.h"
 
 namespace vk
 {
     class Device
     {
     public:
-        Device(Window::Ptr window);
+        Device(Window::Ptr window, uint32_t frameInFlightCount);
         ~Device();
 
         using Ptr = std::shared_ptr<Device>;
-        static Ptr New(Window::Ptr window) { return std::make_shared<Device>(window); }
+        static Ptr New(Window::Ptr window, uint32_t frameInFlightCount = 2) { return std::make_shared<Device>(window, frameInFlightCount); }
 
     private:
+        // 窗口，重建交换链时获取帧缓冲区大小
+        Window::Ptr mWindow;
         // Vulkan实例
         VkInstance mInstance = nullptr;
         // 窗口表面
@@ -22,10 +26,18 @@ namespace vk
         VkPhysicalDevice mPhysicalDevice = nullptr;
         // 逻辑设备
         VkDevice mLogicalDevice = nullptr;
+        // 逻辑设备启用的特性，可选特性按物理设备支持情况启用
+        VkPhysicalDeviceFeatures mDeviceFeatures{};
+        VkPhysicalDeviceVulkan12Features mDeviceVulkan12Features{};
         uint32_t mGraphicsQueueFamilyIndex = 0;
         uint32_t mPresentQueueFamilyIndex = 0;
+        uint32_t mTransferQueueFamilyIndex = 0;
         VkQueue mGraphicsQueue = nullptr;
         VkQueue mPresentQueue = nullptr;
+        // 传输队列，没有专用传输队列族时与图形队列相同
+        VkQueue mTransferQueue = nullptr;
+        // 内存分配器
+        MemoryAllocator::Ptr mMemoryAllocator;
         // 交换链
         VkSwapchainKHR mSwapchain = nullptr;
         uint32_t mSwapchainMinImageCount = 0;
@@ -34,15 +46,20 @@ namespace vk
         VkExtent2D mSwapchainImageExtent{};
         std::vector<VkImage> mSwapchainImageList;
         std::vector<VkImageView> mSwapchainImageViewList;
+        // 同时处理的帧数，各帧资源按此数量创建，与交换链图像数量无关
+        uint32_t mFrameInFlightCount = 2;
+        // 交换链重建次数与最近一次耗时，单位毫秒
+        uint32_t mSwapchainRecreateCount = 0;
+        float mSwapchainRecreateTime = 0;
         // 颜色缓冲区
         VkSampleCountFlagBits mMsaaSampleCount{};
         VkImage mColorImage = nullptr;
-        VkDeviceMemory mColorMemory = nullptr;
+        MemoryAllocator::Allocation mColorMemory{};
         VkImageView mColorImageView = nullptr;
         // 深度缓冲区
         VkFormat mDepthFormat{};
         VkImage mDepthImage = nullptr;
-        VkDeviceMemory mDepthMemory = nullptr;
+        MemoryAllocator::Allocation mDepthMemory{};
         VkImageView mDepthImageView = nullptr;
         // 渲染流程
         VkRenderPass mRenderPass = nullptr;
@@ -50,6 +67,12 @@ namespace vk
         std::vector<VkFramebuffer> mFrameBufferList;
         // 命令池
         VkCommandPool mCommandPool = nullptr;
+        // 上传器
+        Uploader::Ptr mUploader;
+        // 管线缓存
+        std::string mPipelineCacheFilePath = "./pipeline.cache";
+        VkPipelineCache mPipelineCache = nullptr;
+        size_t mPipelineCacheLoadSize = 0;
 
     private:
         void VolkInit();
@@ -57,11 +80,18 @@ namespace vk
         void CreateSurface(Window::Ptr window);
         void EnumerationPhysicalDevice();
         void CreateLogicalDevice();
+        void CreateMemoryAllocator();
         void CreateSwapchain(Window::Ptr window);
         void CreateFrameImageView();
         void CreateRenderPass();
         void CreateFrameBuffer();
+        // 销毁与交换链尺寸相关的资源
+        void DestroyFrameResource();
         void CreateCommandPool();
+        void CreateUploader();
+        void CreatePipelineCache();
+        bool IsPipelineCacheValid(const std::vector<char> &cacheData);
+        void SavePipelineCache();
 
     public:
         VkInstance GetInstance() { return mInstance; }
@@ -73,24 +103,63 @@ namespace vk
         VkFramebuffer GetFrameBuffer(uint32_t frameIndex) { return mFrameBufferList[frameIndex]; }
         VkQueue GetGraphicsQueue() { return mGraphicsQueue; }
         VkQueue GetPresentQueue() { return mPresentQueue; }
+        VkQueue GetTransferQueue() { return mTransferQueue; }
         uint32_t GetSwapchainImageCount() { return mSwapchainImageCount; }
+        uint32_t GetFrameInFlightCount() { return mFrameInFlightCount; }
         VkCommandPool GetCommandPool() { return mCommandPool; }
         VkSampleCountFlagBits GetMsaaSampleCount() { return mMsaaSampleCount; }
         uint32_t GetGraphicsQueueFamilyIndex() { return mGraphicsQueueFamilyIndex; }
+        uint32_t GetTransferQueueFamilyIndex() { return mTransferQueueFamilyIndex; }
+        bool IsHaveDedicatedTransferQueue() { return mTransferQueueFamilyIndex != mGraphicsQueueFamilyIndex; }
+        // 一次间接绘制多个绘制命令
+        bool IsMultiDrawIndirectSupported() { return mDeviceFeatures.multiDrawIndirect; }
+        // 间接绘制命令的firstInstance可以不为0
+        bool IsDrawIndirectFirstInstanceSupported() { return mDeviceFeatures.drawIndirectFirstInstance; }
+        // 间接绘制的数量从缓冲区读取
+        bool IsDrawIndirectCountSupported() { return mDeviceVulkan12Features.drawIndirectCount; }
+        // 着色器可以用非一致的索引访问纹理数组
+        bool IsTextureArrayNonUniformIndexingSupported()
+        {
+            return mDeviceFeatures.shaderSampledImageArrayDynamicIndexing && mDeviceVulkan12Features.shaderSampledImageArrayNonUniformIndexing;
+        }
+        // 可以采样BC1到BC7块压缩格式
+        bool IsTextureCompressionBCSupported() { return mDeviceFeatures.textureCompressionBC; }
+        bool IsFragmentStoresAndAtomicsSupported() { return mDeviceFeatures.fragmentStoresAndAtomics; }
         uint32_t GetSwapchainMinImageCount() { return mSwapchainMinImageCount; }
+        MemoryAllocator::Ptr GetMemoryAllocator() { return mMemoryAllocator; }
+        Uploader::Ptr GetUploader() { return mUploader; }
+        VkPipelineCache GetPipelineCache() { return mPipelineCache; }
+        // 启动时从磁盘加载的有效管线缓存大小，为0表示冷启动
+        size_t GetPipelineCacheLoadSize() { return mPipelineCacheLoadSize; }
+
+        uint32_t GetSwapchainRecreateCount() { return mSwapchainRecreateCount; }
+        float GetSwapchainRecreateTime() { return mSwapchainRecreateTime; }
 
         bool DeviceWaitIdle();
+        // 重建交换链与尺寸相关的附件，窗口最小化时返回false
+        bool RecreateSwapchain();
         bool AllocateMemory(VkMemoryRequirements memoryRequirements, uint32_t memoryTypeIndex, VkDeviceMemory *memory);
+        bool AllocateMemory(VkMemoryRequirements memoryRequirements, VkMemoryPropertyFlags properties, MemoryAllocator::ResourceType type, MemoryAllocator::Allocation *allocation);
+        void FreeMemory(MemoryAllocator::Allocation *allocation);
         bool CreateImageView(VkImage image, VkFormat format, VkImageViewType viewType,
                              VkImageAspectFlags aspectFlags, uint32_t levelCount, uint32_t layerCount, VkImageView *imageView);
-        bool CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, uint64_t size);
+        bool CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, uint64_t size, VkDeviceSize srcOffset = 0, VkDeviceSize dstOffset = 0);
         bool CopyImage(VkImage srcImage, VkImageAspectFlags srcAspectFlags, uint32_t srcMipLevel, uint32_t srcLayerCount, VkImageLayout srcImageLayout,
                        VkImage dstImage, VkImageAspectFlags dstAspectFlags, uint32_t dstMipLevel, uint32_t dstLayerCount, VkImageLayout dstImageLayout,
                        uint32_t width, uint32_t height);
-        bool CopyBufferToImage(VkBuffer srcBuffer,
+        bool CopyBufferToImage(VkBuffer srcBuffer, VkDeviceSize srcOffset,
                                VkImage dstImage, VkImageAspectFlags dstAspectFlags, uint32_t dstMipLevel, uint32_t dstLayerCount, VkImageLayout dstImageLayout,
                                uint32_t width, uint32_t height);
+        // 一次性命令缓冲区录制到上传器的当前批次，不在外部批次中时结束即提交并等待
         bool CreateDisposableCommandBuffer(VkCommandBuffer *commandBuffer);
+        // 在传输队列上将暂存数据整体写入缓冲区或图像，并将所有权转移给图形队列
+        bool UploadBuffer(VkBuffer srcBuffer, VkDeviceSize srcOffset, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize dstOffset = 0);
+        bool UploadImage(VkBuffer srcBuffer, VkDeviceSize srcOffset,
+                         VkImage dstImage, VkImageAspectFlags dstAspectFlags, uint32_t levelCount, uint32_t layerCount,
+                         uint32_t width, uint32_t height);
+        // 在传输队列上写入预先生成的所有mip级别，完成后布局为着色器只读位，不需要再生成mip
+        bool UploadImageLevels(VkBuffer srcBuffer, const std::vector<VkBufferImageCopy> &bufferImageCopyList,
+                               VkImage dstImage, VkImageAspectFlags dstAspectFlags, uint32_t levelCount, uint32_t layerCount);
         bool EndDisposableCommandBuffer(VkCommandBuffer *commandBuffer);
         void GetMaxUsableSampleCount(VkSampleCountFlagBits *sampleCount);
         bool EnumerationSupportedFormats(std::vector<VkFormat> formatList, VkImageTiling imageTiling, VkFormatFeatureFlags formatFeatureFlags, VkFormat *format);
@@ -99,8 +168,8 @@ namespace vk
                          VkFormat format, VkImageType imageType, VkSampleCountFlagBits numSamples,
                          VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties,
                          uint32_t mipLevels, uint32_t layerCount,
-                         VkImage *image, VkDeviceMemory *imageMemory);
-        bool CreateBuffer(uint64_t bufferSize, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer *buffer, VkDeviceMemory *bufferMemory);
+                         VkImage *image, MemoryAllocator::Allocation *imageMemory);
+        bool CreateBuffer(uint64_t bufferSize, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer *buffer, MemoryAllocator::Allocation *bufferMemory);
         bool TransitionImageLayout(VkImage image, VkImageAspectFlags aspectFlags, uint32_t levelCount, uint32_t layerCount, VkImageLayout oldLayout, VkImageLayout newLayout);
         bool GenerateMipmaps(VkImage image, VkFormat imageFormat, int32_t width, int32_t height, uint32_t levelCount);
         bool CreateShaderModule(std::string shaderFilePath, VkShaderModule *shaderModule);
@@ -0,0 +1,60 @@
+#pragma once
+#include "Origin.h"
+
+namespace vk
+{
+    /**
+     * @brief 视锥体剔除器
+     * 世界空间包围球按分量分别连续存储，使用SIMD一次测试多个包围球，AVX时8个，SSE时4个，否则逐个测试
+     * AVX版本单独编译，运行时检测处理器支持后才使用
+     * 设备不支持间接绘制数量时在CPU上剔除，输出可见的索引列表
+     */
+    class FrustumCuller
+    {
+    public:
+        FrustumCuller();
+        ~FrustumCuller();
+
+        using Ptr = std::shared_ptr<FrustumCuller>;
+        static Ptr New()
+        {
+            return std::make_shared<FrustumCuller>();
+        }
+
+    private:
+        // 一次测试的包围球数量，存储长度按此对齐
+        static constexpr uint32_t mLaneCount = 8;
+        // 包围球分量，对齐补齐部分的半径为负无穷，永远不可见
+        std::vector<float> mCenterXList;
+        std::vector<float> mCenterYList;
+        std::vector<float> mCenterZList;
+        std::vector<float> mRadiusList;
+        uint32_t mSphereCount = 0;
+
+    private:
+        // 从投影视图矩阵提取归一化的六个平面，xyz为法线，w为距离
+        static std::array<glm::vec4, 6> ExtractPlane(const glm::mat4 &viewProjectionMat);
+        void CullScalar(const std::array<glm::vec4, 6> &planeList, uint32_t begin, uint32_t end, std::vector<uint32_t> &visibleIndexList);
+        void CullSSE(const std::array<glm::vec4, 6> &planeList, std::vector<uint32_t> &visibleIndexList);
+        // 定义在FrustumCullerAVX.cpp，平面按xyzw连续存放，输出长度至少为对齐后的包围球数量，返回可见数量
+        static uint32_t CullAVX(const float *planeList, const float *centerXList, const float *centerYList, const float *centerZList,
+                                const float *radiusList, uint32_t sphereCount, uint32_t *visibleIndexList);
+        static bool IsAVXCompiled();
+
+    public:
+        // 添加包围球，xyz为球心，w为半径，返回索引
+        uint32_t Add(glm::vec4 sphere);
+        void Set(uint32_t index, glm::vec4 sphere);
+        void Clear();
+        // 测试全部包围球，可见的索引按升序写入列表
+        void Cull(const glm::mat4 &viewProjectionMat, std::vector<uint32_t> &visibleIndexList);
+        uint32_t GetSphereCount() { return mSphereCount; }
+        // 处理器与操作系统支持AVX，且AVX版本已编译
+        static bool IsAVXSupported();
+        // 当前使用的指令集
+        static const char *GetInstructionSet();
+
+        // 在当前线程上剔除随机分布的包围球，返回每秒测试的包围球数量(百万)
+        static float Benchmark(uint32_t sphereCount);
+    };
+} // namespace vk
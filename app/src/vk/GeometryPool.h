@@ -0,0 +1,60 @@
+#pragma once
+#include "Origin.h"
+#include "Device.h"
+#include "Buffer.h"
+
+namespace vk
+{
+    /**
+     * @brief 几何池
+     * 所有网格共用一个顶点缓冲区与一个索引缓冲区，网格按顺序分配其中的一段
+     * 同一个几何池中的网格只需绑定一次缓冲区，可以通过一次间接绘制全部绘制
+     */
+    class GeometryPool
+    {
+    public:
+        // 网格在几何池中的位置，索引值相对于网格自身的第一个顶点
+        struct Mesh
+        {
+            uint32_t FirstIndex = 0;
+            uint32_t IndexCount = 0;
+            int32_t VertexOffset = 0;
+        };
+
+    public:
+        GeometryPool(Device::Ptr device, uint32_t vertexStride, uint32_t vertexCapacity, uint32_t indexCapacity);
+        ~GeometryPool();
+
+        using Ptr = std::shared_ptr<GeometryPool>;
+        static Ptr New(Device::Ptr device, uint32_t vertexStride, uint32_t vertexCapacity, uint32_t indexCapacity)
+        {
+            return std::make_shared<GeometryPool>(device, vertexStride, vertexCapacity, indexCapacity);
+        }
+
+    private:
+        Device::Ptr mDevice;
+        // 几何缓冲区
+        Buffer::Ptr mVertexBuffer;
+        Buffer::Ptr mVertexIndexBuffer;
+        uint32_t mVertexStride = 0;
+        uint32_t mVertexCapacity = 0;
+        uint32_t mIndexCapacity = 0;
+        // 已分配的顶点与索引数量
+        uint32_t mVertexCount = 0;
+        uint32_t mIndexCount = 0;
+
+    private:
+        void CreateGeometryPool();
+
+    public:
+        // 分配一段空间并写入网格数据，容量不足时返回false
+        bool Allocate(const void *vertexData, uint32_t vertexCount, const void *indexData, uint32_t indexCount, Mesh *mesh);
+
+        Buffer::Ptr GetVertexBuffer() { return mVertexBuffer; }
+        Buffer::Ptr GetVertexIndexBuffer() { return mVertexIndexBuffer; }
+        uint32_t GetVertexCount() { return mVertexCount; }
+        uint32_t GetIndexCount() { return mIndexCount; }
+        uint32_t GetVertexCapacity() { return mVertexCapacity; }
+        uint32_t GetIndexCapacity() { return mIndexCapacity; }
+    };
+} // namespace vk
@@ -2,6 +2,7 @@
 #include "Origin.h"
 #include "Device.h"
 #include "Buffer.h"
+#include "TextureCompressor.h"
 
 namespace vk
 {
@@ -19,6 +20,8 @@ namespace vk
 
     public:
         Image(Device::Ptr device, uint32_t width, uint32_t height, VkImageUsageFlags usage, VkMemoryPropertyFlags properties);
+        // mipLevels为0时按尺寸生成完整的mip链
+        Image(Device::Ptr device, uint32_t width, uint32_t height, VkFormat format, uint32_t mipLevels, VkImageUsageFlags usage, VkMemoryPropertyFlags properties);
         ~Image();
 
         using Ptr = std::shared_ptr<Image>;
@@ -26,8 +29,14 @@ namespace vk
         {
             return std::make_shared<Image>(device, width, height, usage, properties);
         }
+        static Ptr New(Device::Ptr device, uint32_t width, uint32_t height, VkFormat format, uint32_t mipLevels, VkImageUsageFlags usage, VkMemoryPropertyFlags properties)
+        {
+            return std::make_shared<Image>(device, width, height, format, mipLevels, usage, properties);
+        }
 
         static ImageInfo OpenImageFile(std::string filePath);
+        // 编码格式对应的sRGB图像格式
+        static VkFormat GetCompressedFormat(TextureCompressor::Format format);
 
     private:
         Device::Ptr mDevice;
@@ -36,20 +45,25 @@ namespace vk
         uint32_t mHeight = 0;
         uint32_t mMipLevels = 0;
         uint32_t mLayerCount = 0;
+        VkFormat mFormat = VK_FORMAT_R8G8B8A8_SRGB;
         VkImage mImage = nullptr;
-        VkDeviceMemory mImageMemory = nullptr;
+        MemoryAllocator::Allocation mImageMemory{};
         VkImageView mImageView = nullptr;
 
     private:
         void CreateImageBuffer(VkImageUsageFlags usage, VkMemoryPropertyFlags properties);
+        bool WriteBufferRange(VkBuffer buffer, VkDeviceSize offset);
 
     public:
         bool WriteImage(Image::Ptr image);
         bool WriteBuffer(Buffer::Ptr buffer);
         bool WriteData(void *data);
+        // 写入预先生成的所有mip级别，级别数量与尺寸需要与图像一致
+        bool WriteCompressedData(const uint8_t *data, const std::vector<TextureCompressor::MipLevel> &mipLevelList);
 
         uint32_t GetMipLevels() { return mMipLevels; }
         uint32_t GetLayerCount() { return mLayerCount; }
+        VkFormat GetFormat() { return mFormat; }
         VkImage GetImage() { return mImage; }
         VkImageView GetImageView() { return mImageView; }
         uint32_t GetWidht() { return mWidth; };
@@ -0,0 +1,89 @@
+#pragma once
+#include "Origin.h"
+
+namespace vk
+{
+    /**
+     * @brief 任务系统
+     * 每个工作线程拥有自己的任务队列，从队尾取出自己提交的任务，空闲时从其他队列的队首窃取任务
+     * 任务通过计数器表示完成状态与依赖关系，等待计数器的线程会同时执行队列中的任务
+     */
+    class JobSystem
+    {
+    public:
+        using Job = std::function<void()>;
+
+        // 任务计数器，提交时加一，任务完成时减一，归零后执行依赖它的任务
+        class Counter
+        {
+        public:
+            bool IsComplete() { return mValue.load(std::memory_order_acquire) == 0; }
+
+        private:
+            friend class JobSystem;
+            std::atomic<uint32_t> mValue{0};
+            std::mutex mMutex;
+            std::vector<std::pair<Job, Counter *>> mContinuationList;
+        };
+
+    public:
+        JobSystem(uint32_t workerCount);
+        ~JobSystem();
+
+        using Ptr = std::shared_ptr<JobSystem>;
+        static Ptr New(uint32_t workerCount = std::max(2u, std::thread::hardware_concurrency()) - 1)
+        {
+            return std::make_shared<JobSystem>(workerCount);
+        }
+
+    private:
+        struct Task
+        {
+            Job Function;
+            Counter *pCounter = nullptr;
+        };
+        struct WorkerQueue
+        {
+            std::deque<Task> TaskList;
+            std::mutex Mutex;
+        };
+
+    private:
+        std::vector<std::thread> mWorkerList;
+        // 最后一个队列属于非工作线程，主线程提交的任务放入其中
+        std::vector<std::unique_ptr<WorkerQueue>> mQueueList;
+        std::atomic<uint32_t> mPendingTaskCount{0};
+        std::mutex mSleepMutex;
+        std::condition_variable mSleepCondition;
+        bool mIsStop = false;
+        // 统计
+        std::atomic<uint64_t> mExecuteCount{0};
+        std::atomic<uint64_t> mStealCount{0};
+
+    private:
+        void CreateWorker(uint32_t workerCount);
+        void WorkerLoop(uint32_t workerIndex);
+        uint32_t GetQueueIndex();
+        void Push(Task task);
+        // 取出一个任务并执行，没有任务时返回false
+        bool ExecuteOne(uint32_t queueIndex);
+        void Finish(Counter *counter);
+
+    public:
+        // 提交任务，counter可以为空
+        void Run(Job job, Counter *counter = nullptr);
+        // dependency归零后再提交任务
+        void Run(Counter *dependency, Job job, Counter *counter = nullptr);
+        // 将[0, count)按groupSize分组并行执行
+        void ParallelFor(uint32_t count, uint32_t groupSize, std::function<void(uint32_t, uint32_t)> job, Counter *counter);
+        // 等待计数器归零，等待期间执行队列中的任务
+        void Wait(Counter *counter);
+
+        uint32_t GetWorkerCount() { return mWorkerList.size(); }
+        uint64_t GetExecuteCount() { return mExecuteCount; }
+        uint64_t GetStealCount() { return mStealCount; }
+
+        // 测试不同线程数下的任务吞吐量
+        static void Benchmark(uint32_t jobCount);
+    };
+} // namespace vk
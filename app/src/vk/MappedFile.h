@@ -0,0 +1,39 @@
+#pragma once
+#include "Origin.h"
+
+namespace vk
+{
+    /**
+     * @brief 只读内存映射文件
+     * 文件内容按需由系统换页读入，映射失败或文件为空时数据为空
+     */
+    class MappedFile
+    {
+    public:
+        MappedFile(std::string filePath);
+        ~MappedFile();
+
+        using Ptr = std::shared_ptr<MappedFile>;
+        static Ptr New(std::string filePath)
+        {
+            return std::make_shared<MappedFile>(filePath);
+        }
+
+    private:
+        const uint8_t *mData = nullptr;
+        size_t mSize = 0;
+#ifdef _WIN32
+        void *mFile = nullptr;
+        void *mMapping = nullptr;
+#else
+        int mFile = -1;
+#endif
+
+    private:
+        bool MapFile(std::string filePath);
+
+    public:
+        const uint8_t *GetData() { return mData; }
+        size_t GetSize() { return mSize; }
+    };
+} // namespace vk
@@ -0,0 +1,100 @@
+#pragma once
+#include "Origin.h"
+
+namespace vk
+{
+    /**
+     * @brief 内存分配器
+     * 按内存类型申请大块设备内存，缓冲区与图像从中子分配，避免每个资源单独调用vkAllocateMemory
+     */
+    class MemoryAllocator
+    {
+    public:
+        // 资源排列方式，不同排列方式的资源相邻时需要满足bufferImageGranularity
+        enum class ResourceType
+        {
+            Free,
+            Linear,
+            Optimal,
+        };
+        // 内存块中的区段
+        struct Chunk
+        {
+            VkDeviceSize Size = 0;
+            ResourceType Type = ResourceType::Free;
+        };
+        // 内存块
+        struct Block
+        {
+            VkDeviceMemory Memory = nullptr;
+            VkDeviceSize Size = 0;
+            uint32_t MemoryTypeIndex = 0;
+            void *MappedData = nullptr;
+            bool IsDedicated = false;
+            // 按偏移排序的全部区段
+            std::map<VkDeviceSize, Chunk> ChunkList;
+            // 空闲区段，按大小排序，值为偏移
+            std::multimap<VkDeviceSize, VkDeviceSize> FreeList;
+            VkDeviceSize UsedBytes = 0;
+            uint32_t AllocationCount = 0;
+        };
+        // 子分配结果
+        struct Allocation
+        {
+            VkDeviceMemory Memory = nullptr;
+            VkDeviceSize Offset = 0;
+            VkDeviceSize Size = 0;
+            void *MappedData = nullptr;
+            Block *pBlock = nullptr;
+        };
+        // 统计信息
+        struct Statistics
+        {
+            uint32_t BlockCount = 0;
+            uint32_t DedicatedBlockCount = 0;
+            uint32_t AllocationCount = 0;
+            uint32_t FreeRangeCount = 0;
+            VkDeviceSize BlockBytes = 0;
+            VkDeviceSize UsedBytes = 0;
+            VkDeviceSize FreeBytes = 0;
+            VkDeviceSize LargestFreeRange = 0;
+            // 碎片率，1 - 最大空闲区段 / 空闲总量
+            float Fragmentation = 0.0f;
+        };
+
+    public:
+        MemoryAllocator(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, VkDeviceSize blockSize);
+        ~MemoryAllocator();
+
+        using Ptr = std::shared_ptr<MemoryAllocator>;
+        static Ptr New(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, VkDeviceSize blockSize = 64 * 1024 * 1024)
+        {
+            return std::make_shared<MemoryAllocator>(physicalDevice, logicalDevice, blockSize);
+        }
+
+    private:
+        VkDevice mLogicalDevice = nullptr;
+        VkPhysicalDeviceMemoryProperties mMemoryProperties{};
+        VkDeviceSize mBufferImageGranularity = 1;
+        VkDeviceSize mBlockSize = 0;
+        uint32_t mMaxMemoryAllocationCount = 0;
+        // 每种内存类型的内存块列表
+        std::vector<std::vector<std::unique_ptr<Block>>> mBlockList;
+        std::mutex mMutex;
+
+    private:
+        VkDeviceSize GetPreferredBlockSize(uint32_t memoryTypeIndex);
+        Block *CreateBlock(uint32_t memoryTypeIndex, VkDeviceSize size, bool isDedicated);
+        void DestroyBlock(Block *block);
+        bool AllocateFromBlock(Block *block, VkMemoryRequirements memoryRequirements, ResourceType type, Allocation *allocation);
+        void InsertFreeChunk(Block *block, VkDeviceSize offset, VkDeviceSize size);
+        void EraseFreeChunk(Block *block, VkDeviceSize offset, VkDeviceSize size);
+
+    public:
+        bool Allocate(VkMemoryRequirements memoryRequirements, uint32_t memoryTypeIndex, ResourceType type, Allocation *allocation);
+        void Free(Allocation *allocation);
+
+        Statistics GetStatistics();
+        uint32_t GetMaxMemoryAllocationCount() { return mMaxMemoryAllocationCount; }
+    };
+} // namespace vk
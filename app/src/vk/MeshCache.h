@@ -0,0 +1,140 @@
+#pragma once
+#include "Origin.h"
+#include "ModelBuffer.h"
+#include "MappedFile.h"
+#include "ContentHash.h"
+
+namespace vk
+{
+    /**
+     * @brief 网格缓存
+     * 导入后的网格写入二进制文件，之后启动时映射文件直接读取，跳过Assimp导入
+     * 文件依次为文件头、网格表、顶点与索引数据，数据按mBlobAlignment对齐，可以直接拷贝到暂存内存
+     * 源文件哈希、导入标志、顶点大小或版本不一致时缓存失效
+     */
+    class MeshCache
+    {
+    public:
+        // 文件头
+        struct Header
+        {
+            uint32_t Magic;
+            uint32_t Version;
+            uint64_t SourceHash;
+            uint32_t ImportFlags;
+            uint32_t VertexStride;
+            uint32_t MeshCount;
+            uint32_t Reserved;
+        };
+        // 网格表的一项，偏移为相对文件开头的字节数
+        struct MeshEntry
+        {
+            uint64_t VertexOffset;
+            uint64_t IndexOffset;
+            uint32_t VertexCount;
+            uint32_t IndexCount;
+            ModelBuffer::BoundingVolume Bounds;
+            char Name[64];
+        };
+
+    private:
+        static constexpr uint32_t mMagic = 0x4853454D; // MESH
+        static constexpr uint32_t mVersion = 3;
+        static constexpr uint64_t mBlobAlignment = 16;
+
+    private:
+        static uint64_t Align(uint64_t offset) { return (offset + mBlobAlignment - 1) & ~(mBlobAlignment - 1); }
+        // 按文件头与网格表检查缓存是否可用
+        static bool Validate(MappedFile::Ptr file, uint64_t sourceHash, uint32_t importFlags, uint32_t vertexStride);
+
+    public:
+        // 源文件内容的哈希，读取失败时返回0
+        static uint64_t HashFile(std::string filePath);
+        static std::string GetCachePath(std::string sourceFilePath) { return sourceFilePath + ".meshcache"; }
+
+        // 写入缓存，先写入临时文件再替换，失败时返回false
+        template <typename TVertex>
+        static bool Save(std::string cacheFilePath, uint64_t sourceHash, uint32_t importFlags, const std::vector<ModelBuffer::ModelInfo<TVertex>> &modelInfoList)
+        {
+            static_assert(std::is_trivially_copyable_v<TVertex>, "Vertex must be trivially copyable!");
+            Header FileHeader{};
+            FileHeader.Magic = mMagic;
+            FileHeader.Version = mVersion;
+            FileHeader.SourceHash = sourceHash;
+            FileHeader.ImportFlags = importFlags;
+            FileHeader.VertexStride = sizeof(TVertex);
+            FileHeader.MeshCount = modelInfoList.size();
+            // 计算每个网格数据的偏移
+            std::vector<MeshEntry> MeshTable(modelInfoList.size());
+            uint64_t Offset = Align(sizeof(Header) + sizeof(MeshEntry) * MeshTable.size());
+            for (size_t i = 0; i < modelInfoList.size(); i++)
+            {
+                MeshTable[i].VertexOffset = Offset;
+                MeshTable[i].VertexCount = modelInfoList[i].GetVertexCount();
+                Offset = Align(Offset + sizeof(TVertex) * MeshTable[i].VertexCount);
+                MeshTable[i].IndexOffset = Offset;
+                MeshTable[i].IndexCount = modelInfoList[i].GetVertexIndexCount();
+                Offset = Align(Offset + sizeof(uint32_t) * MeshTable[i].IndexCount);
+                MeshTable[i].Bounds = modelInfoList[i].Bounds;
+                memset(MeshTable[i].Name, 0, sizeof(MeshTable[i].Name));
+                strncpy(MeshTable[i].Name, modelInfoList[i].ModelName.c_str(), sizeof(MeshTable[i].Name) - 1);
+            }
+            std::string TempFilePath = cacheFilePath + ".tmp";
+            {
+                std::ofstream File(TempFilePath, std::ios::binary | std::ios::trunc);
+                if (!File.is_open())
+                {
+                    return false;
+                }
+                // 写入数据块前补齐到对齐位置
+                const char Padding[mBlobAlignment]{};
+                auto WriteBlob = [&File, &Padding](uint64_t offset, const void *data, uint64_t size)
+                {
+                    uint64_t Position = static_cast<uint64_t>(File.tellp());
+                    File.write(Padding, offset - Position);
+                    File.write(static_cast<const char *>(data), size);
+                };
+                File.write(reinterpret_cast<const char *>(&FileHeader), sizeof(Header));
+                File.write(reinterpret_cast<const char *>(MeshTable.data()), sizeof(MeshEntry) * MeshTable.size());
+                for (size_t i = 0; i < modelInfoList.size(); i++)
+                {
+                    WriteBlob(MeshTable[i].VertexOffset, modelInfoList[i].GetVertexData(), sizeof(TVertex) * MeshTable[i].VertexCount);
+                    WriteBlob(MeshTable[i].IndexOffset, modelInfoList[i].GetVertexIndexData(), sizeof(uint32_t) * MeshTable[i].IndexCount);
+                }
+                if (!File.good())
+                {
+                    return false;
+                }
+            }
+            // 部分平台上目标存在时无法替换，先删除旧缓存
+            std::remove(cacheFilePath.c_str());
+            return std::rename(TempFilePath.c_str(), cacheFilePath.c_str()) == 0;
+        }
+
+        // 映射缓存并读取网格，顶点与索引指向映射的文件，缓存不存在或失效时返回false
+        template <typename TVertex>
+        static bool Load(std::string cacheFilePath, uint64_t sourceHash, uint32_t importFlags, std::vector<ModelBuffer::ModelInfo<TVertex>> *modelInfoList)
+        {
+            MappedFile::Ptr File = MappedFile::New(cacheFilePath);
+            if (!Validate(File, sourceHash, importFlags, sizeof(TVertex)))
+            {
+                return false;
+            }
+            const Header *FileHeader = reinterpret_cast<const Header *>(File->GetData());
+            const MeshEntry *MeshTable = reinterpret_cast<const MeshEntry *>(File->GetData() + sizeof(Header));
+            modelInfoList->resize(FileHeader->MeshCount);
+            for (uint32_t i = 0; i < FileHeader->MeshCount; i++)
+            {
+                // 数据块不拷贝，由几何池直接从映射内存写入暂存内存
+                (*modelInfoList)[i].Storage = File;
+                (*modelInfoList)[i].MappedVertex = reinterpret_cast<const TVertex *>(File->GetData() + MeshTable[i].VertexOffset);
+                (*modelInfoList)[i].MappedVertexIndex = reinterpret_cast<const uint32_t *>(File->GetData() + MeshTable[i].IndexOffset);
+                (*modelInfoList)[i].MappedVertexCount = MeshTable[i].VertexCount;
+                (*modelInfoList)[i].MappedVertexIndexCount = MeshTable[i].IndexCount;
+                (*modelInfoList)[i].ModelName = std::string(MeshTable[i].Name, strnlen(MeshTable[i].Name, sizeof(MeshTable[i].Name)));
+                (*modelInfoList)[i].Bounds = MeshTable[i].Bounds;
+            }
+            return true;
+        }
+    };
+} // namespace vk
@@ -2,35 +2,104 @@
 #include "Origin.h"
 #include "Device.h"
 #include "Buffer.h"
+#include "JobSystem.h"
 
 namespace vk
 {
     class ModelBuffer
     {
     public:
+        // 包围盒与包围球，包围球xyz为球心，w为半径
+        struct BoundingVolume
+        {
+            glm::vec3 Min{};
+            glm::vec3 Max{};
+            glm::vec4 Sphere{};
+        };
+
         template <typename TVertex>
         struct ModelInfo
         {
             std::vector<TVertex> Vertex;
             std::vector<uint32_t> VertexIndex;
             std::string ModelName;
+            // 模型空间的包围体，节点变换已烘焙到顶点
+            BoundingVolume Bounds;
+            // 从缓存读取时顶点与索引直接指向映射的文件，不拷贝到Vertex与VertexIndex，Storage保持映射有效
+            std::shared_ptr<const void> Storage;
+            const TVertex *MappedVertex = nullptr;
+            const uint32_t *MappedVertexIndex = nullptr;
+            uint32_t MappedVertexCount = 0;
+            uint32_t MappedVertexIndexCount = 0;
+
+            const TVertex *GetVertexData() const { return Storage ? MappedVertex : Vertex.data(); }
+            uint32_t GetVertexCount() const { return Storage ? MappedVertexCount : static_cast<uint32_t>(Vertex.size()); }
+            const uint32_t *GetVertexIndexData() const { return Storage ? MappedVertexIndex : VertexIndex.data(); }
+            uint32_t GetVertexIndexCount() const { return Storage ? MappedVertexIndexCount : static_cast<uint32_t>(VertexIndex.size()); }
+        };
+
+        // 节点树展开后的网格，以及节点层级累积的变换
+        struct MeshNode
+        {
+            aiMesh *Mesh = nullptr;
+            glm::mat4 Transform{1.0f};
         };
 
+        // 转换网格，顶点位置与法线按节点变换烘焙到模型空间
+        template <typename TVertex>
+        using ProcessMeshFunction = std::function<ModelInfo<TVertex>(aiMesh *, const glm::mat4 &)>;
+
+        // 按深度优先顺序展开节点树
+        static void FlattenNode(const aiScene *scene, aiNode *node, const glm::mat4 &parentTransform, std::vector<MeshNode> *meshNodeList);
+
         template <typename TVertex>
-        static void ProcessNode(const aiScene *scene, aiNode *node, std::vector<ModelInfo<TVertex>> *modelInfoList, std::function<ModelInfo<TVertex>(aiMesh *)> processMesh)
+        static void ProcessMeshNode(const MeshNode &meshNode, ProcessMeshFunction<TVertex> &processMesh, ModelInfo<TVertex> *modelInfo)
         {
-            if (scene->HasMeshes())
-            {
-                for (size_t i = 0; i < node->mNumMeshes; i++)
-                {
-                    modelInfoList->push_back(processMesh(scene->mMeshes[node->mMeshes[i]]));
-                }
-            }
-            for (size_t i = 0; i < node->mNumChildren; i++)
+            *modelInfo = processMesh(meshNode.Mesh, meshNode.Transform);
+            // 包围体从导入的顶点位置计算，与顶点结构无关，再按烘焙到顶点的同一变换变换
+            modelInfo->Bounds = TransformBoundingVolume(ComputeBoundingVolume(reinterpret_cast<const float *>(meshNode.Mesh->mVertices), sizeof(aiVector3D), meshNode.Mesh->mNumVertices),
+                                                        meshNode.Transform);
+            //
+        }
+
+        template <typename TVertex>
+        static void ProcessNode(const aiScene *scene, aiNode *node, std::vector<ModelInfo<TVertex>> *modelInfoList, ProcessMeshFunction<TVertex> processMesh,
+                                const glm::mat4 &parentTransform = glm::mat4(1.0f))
+        {
+            std::vector<MeshNode> MeshNodeList;
+            FlattenNode(scene, node, parentTransform, &MeshNodeList);
+            size_t First = modelInfoList->size();
+            modelInfoList->resize(First + MeshNodeList.size());
+            for (size_t i = 0; i < MeshNodeList.size(); i++)
             {
-                ProcessNode(scene, node->mChildren[i], modelInfoList, processMesh);
+                ProcessMeshNode(MeshNodeList[i], processMesh, &(*modelInfoList)[First + i]);
             }
         }
+        // 展开节点树后每个网格一个任务并行转换，结果顺序与ProcessNode相同，processMesh需要可以在多个线程上同时调用
+        template <typename TVertex>
+        static void ProcessNodeParallel(const aiScene *scene, aiNode *node, std::vector<ModelInfo<TVertex>> *modelInfoList, ProcessMeshFunction<TVertex> processMesh,
+                                        JobSystem::Ptr jobSystem, const glm::mat4 &parentTransform = glm::mat4(1.0f))
+        {
+            std::vector<MeshNode> MeshNodeList;
+            FlattenNode(scene, node, parentTransform, &MeshNodeList);
+            size_t First = modelInfoList->size();
+            modelInfoList->resize(First + MeshNodeList.size());
+            JobSystem::Counter ConvertCounter;
+            jobSystem->ParallelFor(MeshNodeList.size(), 1, [&MeshNodeList, &processMesh, modelInfoList, First](uint32_t first, uint32_t last)
+                                   {
+                                       for (uint32_t i = first; i < last; i++)
+                                       {
+                                           ProcessMeshNode(MeshNodeList[i], processMesh, &(*modelInfoList)[First + i]);
+                                       } },
+                                   &ConvertCounter);
+            //
+            jobSystem->Wait(&ConvertCounter);
+        }
+        // 计算位置的包围体，stride为相邻位置间隔的字节数，不小于3个float
+        static BoundingVolume ComputeBoundingVolume(const float *positionData, size_t stride, size_t count);
+        // 变换包围体，包围盒保持轴对齐
+        static BoundingVolume TransformBoundingVolume(const BoundingVolume &boundingVolume, const glm::mat4 &transform);
+        static glm::mat4 ToMat4(const aiMatrix4x4 &matrix);
 
     public:
         ModelBuffer(Device::Ptr device, void *vertexData, uint64_t vertexDataSize, void *indexData, uint64_t indexDataSize, uint32_t vertexIndexCount);
@@ -21,9 +21,18 @@
 #include <memory>
 #include <optional>
 #include <set>
+#include <map>
+#include <mutex>
 #include <fstream>
 #include <functional>
 #include <chrono>
+#include <thread>
+#include <future>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
+#include <numeric>
+#include <filesystem>
 
 namespace vk
 {
@@ -14,6 +14,8 @@ namespace vk
             std::vector<ShaderModule::Ptr> ShaderModuleList;
             VkVertexInputBindingDescription VertexInputBindingDescription;
             std::vector<VkVertexInputAttributeDescription> VertexInputAttributeDescriptionList;
+            // 半透明管线的绘制排在不透明绘制之后，按从远到近的顺序录制
+            bool IsTranslucent = false;
         };
 
     public:
@@ -27,11 +29,13 @@ namespace vk
         Device::Ptr mDevice;
         // 渲染管线
         VkPipeline mPipeline = nullptr;
+        bool mIsTranslucent = false;
 
     private:
         void CreatePipeline(DescriptorSetLayout::Ptr descriptorSet, PipelineInfo info);
 
     public:
         VkPipeline GetPipeline() { return mPipeline; }
+        bool IsTranslucent() { return mIsTranslucent; }
     };
 } // namespace vk
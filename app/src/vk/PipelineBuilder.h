@@ -0,0 +1,46 @@
+#pragma once
+#include "Origin.h"
+#include "Device.h"
+#include "Pipeline.h"
+#include "JobSystem.h"
+
+namespace vk
+{
+    /**
+     * @brief 管线构建器
+     * 在任务系统上编译渲染管线，所有管线共用设备的管线缓存，调用方通过future获取结果
+     */
+    class PipelineBuilder
+    {
+    public:
+        // 管线编译记录
+        struct BuildRecord
+        {
+            std::string Name;
+            // 编译耗时，单位毫秒
+            float BuildTime = 0;
+        };
+
+    public:
+        PipelineBuilder(Device::Ptr device, JobSystem::Ptr jobSystem);
+        ~PipelineBuilder();
+
+        using Ptr = std::shared_ptr<PipelineBuilder>;
+        static Ptr New(Device::Ptr device, JobSystem::Ptr jobSystem) { return std::make_shared<PipelineBuilder>(device, jobSystem); }
+
+    private:
+        Device::Ptr mDevice;
+        JobSystem::Ptr mJobSystem;
+        // 未完成的编译任务
+        JobSystem::Counter mBuildCounter;
+        // 编译记录
+        std::vector<BuildRecord> mBuildRecordList;
+        std::mutex mRecordMutex;
+
+    public:
+        // 提交管线编译任务
+        std::future<Pipeline::Ptr> Build(std::string name, DescriptorSetLayout::Ptr descriptorSet, Pipeline::PipelineInfo info);
+
+        std::vector<BuildRecord> GetBuildRecordList();
+    };
+} // namespace vk
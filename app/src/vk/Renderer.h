@@ -5,49 +5,169 @@
 #include "Pipeline.h"
 #include "DescriptorSet.h"
 #include "ModelBuffer.h"
+#include "GeometryPool.h"
+#include "JobSystem.h"
 
 namespace vk
 {
     class Renderer
     {
     public:
-        Renderer(Device::Ptr device);
+        Renderer(Device::Ptr device, JobSystem::Ptr jobSystem);
         ~Renderer();
 
         using Ptr = std::shared_ptr<Renderer>;
-        static Ptr New(Device::Ptr device) { return std::make_shared<Renderer>(device); }
+        static Ptr New(Device::Ptr device, JobSystem::Ptr jobSystem) { return std::make_shared<Renderer>(device, jobSystem); }
+
+    private:
+        // 绘制命令
+        struct DrawCommand
+        {
+            // 排序键，从高到低依次为半透明标记1位、管线15位，材质、网格与深度各16位
+            uint64_t SortKey = 0;
+            Buffer::Ptr VertexBuffer;
+            Buffer::Ptr VertexIndexBuffer;
+            DescriptorSet::Ptr Descriptor;
+            Pipeline::Ptr GraphicsPipeline;
+            std::vector<uint32_t> DynamicOffsetList;
+            // 直接绘制的参数
+            VkDrawIndexedIndirectCommand DrawParameter{};
+            // 间接绘制的参数缓冲区，不为空时从中读取绘制参数
+            Buffer::Ptr IndirectBuffer;
+            uint32_t IndirectDrawCount = 0;
+            // 间接绘制的数量缓冲区，不为空时IndirectDrawCount为最大绘制数量
+            Buffer::Ptr IndirectCountBuffer;
+        };
+        // 录制任务的命令池与次级命令缓冲区
+        struct ThreadCommand
+        {
+            VkCommandPool CommandPool = nullptr;
+            VkCommandBuffer CommandBuffer = nullptr;
+        };
 
     private:
         Device::Ptr mDevice;
-        // 命令缓冲区
+        JobSystem::Ptr mJobSystem;
+        // 命令缓冲区，按同时处理的帧数创建
         std::vector<VkCommandBuffer> mCommandBufferList;
         // 围栏
         std::vector<VkFence> mFenceList;
         // 信号
         std::vector<VkSemaphore> mStartRenderList;
+        // 呈现信号，按交换链图像创建
         std::vector<VkSemaphore> mSubmitPresentList;
+        // 各交换链图像最近一次使用的帧围栏
+        std::vector<VkFence> mImageFenceList;
         // 多帧渲染资源索引
         uint32_t mCurrentIndex = 0;
+        // 交换链需要重建
+        bool mIsSwapchainDirty = false;
+        // CPU录制下一帧时GPU可以继续执行上一帧
+        bool mIsFrameOverlap = true;
+        // 本帧等待围栏与录制命令的耗时，单位毫秒
+        float mFenceWaitTime = 0;
+        float mRecordTime = 0;
+        // 本帧收集的绘制命令，录制前按排序键排序
+        std::vector<DrawCommand> mDrawCommandList;
+        // 本帧收集的计算命令，在渲染流程开始前按提交顺序录制
+        std::vector<std::function<void(VkCommandBuffer)>> mComputeOperationList;
+        // 排序键中管线、材质与网格的编号，每帧重新分配，不会保留已释放对象的地址
+        std::map<const void *, uint16_t> mSortIdMap;
+        // 深度量化范围，与相机远平面一致
+        float mSortDepthRange = 1000.0f;
+        // 本帧实际执行与跳过的绑定命令数量
+        std::atomic<uint32_t> mBindIssuedCount{0};
+        std::atomic<uint32_t> mBindSkippedCount{0};
+        Gui::Ptr mGui;
+        // 多线程录制
+        bool mIsParallelRecord = false;
+        uint32_t mMinDrawPerThread = 32;
+        uint32_t mRecordThreadUsed = 0;
+        // 每帧每个录制任务独占的命令池，数量为任务系统线程数加一，最后一个用于ImGui
+        std::vector<std::vector<ThreadCommand>> mThreadCommandList;
 
     private:
         void AllocateCommandBuffer();
         void CreateSyncObjects();
+        void CreateThreadCommand();
+        void CreateImageSyncObjects();
+        void DestroyImageSyncObjects();
+        // 重建交换链与按图像创建的同步对象
+        bool RecreateSwapchain();
+
+        // 等待当前帧资源空闲
+        void WaitFrame();
+        // 获取交换链图像，交换链过期时返回false
+        bool AcquireFrame(uint32_t *frameIndex);
+        // 录制渲染命令到当前帧命令缓冲区
+        void RecordFrame(uint32_t frameIndex, std::function<void(uint32_t)> drawOperations);
+        void SubmitFrame(uint32_t frameIndex);
+        void PresentFrame(uint32_t frameIndex);
 
+        // 设置视口与剪裁命令
+        void SetViewport(VkCommandBuffer commandBuffer, VkExtent2D extent);
         // 绑定渲染管线
-        void BindPipeline(VkPipeline pipeline);
+        void BindPipeline(VkCommandBuffer commandBuffer, VkPipeline pipeline);
         // 绑定顶点缓冲区命令
-        void BindVertexBuffer(Buffer::Ptr vertexBuffer);
+        void BindVertexBuffer(VkCommandBuffer commandBuffer, Buffer::Ptr vertexBuffer);
         // 绑定顶点索引缓冲区命令
-        void BindIndexBuffer(Buffer::Ptr vertexIndexBuffer);
+        void BindIndexBuffer(VkCommandBuffer commandBuffer, Buffer::Ptr vertexIndexBuffer);
         // 绑定描述符集命令
-        void BindDescriptorSet(VkPipelineLayout pipelineLayout, VkDescriptorSet descriptorSet);
+        void BindDescriptorSet(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, VkDescriptorSet descriptorSet, const std::vector<uint32_t> &dynamicOffsetList);
         // 使用带顶点索引的渲染图形命令
-        void DrawIndexed(uint32_t vertexIndexCount);
+        void DrawIndexed(VkCommandBuffer commandBuffer, const VkDrawIndexedIndirectCommand &drawParameter);
+        // 使用带顶点索引的间接渲染图形命令，设备不支持多绘制间接时逐个提交
+        void DrawIndexedIndirect(VkCommandBuffer commandBuffer, Buffer::Ptr indirectBuffer, uint32_t drawCount);
+        // 绘制数量从缓冲区读取的间接渲染图形命令
+        void DrawIndexedIndirectCount(VkCommandBuffer commandBuffer, Buffer::Ptr indirectBuffer, Buffer::Ptr countBuffer, uint32_t maxDrawCount);
+        uint16_t GetSortId(const void *object);
+        // 计算排序键并加入绘制命令列表
+        void PushDrawCommand(DrawCommand command, float depth);
+        // 录制绘制命令列表中的一段，与上一条绘制相同的绑定不再重复录制
+        void RecordDrawCommand(VkCommandBuffer commandBuffer, size_t first, size_t last);
+
+        // 开始录制继承渲染流程的次级命令缓冲区
+        void BeginSecondaryCommandBuffer(VkCommandBuffer commandBuffer, VkFramebuffer frameBuffer);
+        // 将绘制命令分段提交到任务系统，主命令缓冲区按顺序执行各次级命令缓冲区
+        void RecordParallel(uint32_t frameIndex);
 
     public:
         void Render(std::function<void(uint32_t)> drawOperations);
+        // 窗口尺寸变化时标记交换链过期，下一帧开始前重建
+        void SetSwapchainDirty() { mIsSwapchainDirty = true; }
+        void SetFrameOverlap(bool isFrameOverlap) { mIsFrameOverlap = isFrameOverlap; }
+        void SetSortDepthRange(float sortDepthRange) { mSortDepthRange = std::max(sortDepthRange, 1e-3f); }
+        bool IsFrameOverlap() { return mIsFrameOverlap; }
+        float GetFenceWaitTime() { return mFenceWaitTime; }
+        float GetRecordTime() { return mRecordTime; }
+
+        void SetParallelRecord(bool isParallelRecord) { mIsParallelRecord = isParallelRecord; }
+        bool IsParallelRecord() { return mIsParallelRecord; }
+        uint32_t GetRecordThreadCount() { return mJobSystem->GetWorkerCount() + 1; }
+        // 本帧实际参与录制的线程数，单线程录制时为0
+        uint32_t GetRecordThreadUsed() { return mRecordThreadUsed; }
+        size_t GetDrawCount() { return mDrawCommandList.size(); }
+        uint32_t GetBindIssuedCount() { return mBindIssuedCount; }
+        uint32_t GetBindSkippedCount() { return mBindSkippedCount; }
 
-        void Draw(ModelBuffer::Ptr modelBuffer, DescriptorSet::Ptr descriptorSet, Pipeline::Ptr pipeline);
+        // 绘制命令先收集，录制阶段按管线、材质、网格与深度排序后统一写入命令缓冲区
+        // 动态偏移按绑定号顺序排列，数量需与描述符集布局中的动态描述符数量一致
+        // 深度为到相机的距离，相同状态的绘制按由近到远排列
+        void Draw(ModelBuffer::Ptr modelBuffer, DescriptorSet::Ptr descriptorSet, Pipeline::Ptr pipeline, std::vector<uint32_t> dynamicOffsetList = {}, float depth = 0.0f);
+        // 实例化绘制，着色器通过gl_InstanceIndex读取每个实例的数据
+        void DrawInstanced(ModelBuffer::Ptr modelBuffer, DescriptorSet::Ptr descriptorSet, Pipeline::Ptr pipeline, uint32_t instanceCount,
+                           std::vector<uint32_t> dynamicOffsetList = {}, float depth = 0.0f);
+        // 绘制几何池中的网格，firstInstance作为着色器中gl_InstanceIndex的起始值，可用于读取每个绘制的数据
+        void DrawMesh(GeometryPool::Ptr geometryPool, const GeometryPool::Mesh &mesh, DescriptorSet::Ptr descriptorSet, Pipeline::Ptr pipeline, uint32_t firstInstance,
+                      std::vector<uint32_t> dynamicOffsetList = {}, float depth = 0.0f);
+        // 间接绘制几何池中的网格，indirectBuffer中依次存放drawCount个VkDrawIndexedIndirectCommand
+        void DrawIndirect(GeometryPool::Ptr geometryPool, DescriptorSet::Ptr descriptorSet, Pipeline::Ptr pipeline, Buffer::Ptr indirectBuffer, uint32_t drawCount,
+                          std::vector<uint32_t> dynamicOffsetList = {}, float depth = 0.0f);
+        // 间接绘制的数量由countBuffer中的值决定，不超过maxDrawCount，需要设备支持间接绘制数量
+        void DrawIndirectCount(GeometryPool::Ptr geometryPool, DescriptorSet::Ptr descriptorSet, Pipeline::Ptr pipeline, Buffer::Ptr indirectBuffer, Buffer::Ptr countBuffer,
+                               uint32_t maxDrawCount, std::vector<uint32_t> dynamicOffsetList = {}, float depth = 0.0f);
+        // 在渲染流程开始前录制计算命令，例如生成本帧间接绘制参数的剔除
+        void Compute(std::function<void(VkCommandBuffer)> computeOperation);
         void DrawGUI(Gui::Ptr gui);
     };
 } // namespace vk
@@ -9,17 +9,36 @@ namespace vk
     class ShaderBuffer
     {
     public:
-        ShaderBuffer(Device::Ptr device, size_t bufferSize, bool isWritePerFrame);
+        ShaderBuffer(Device::Ptr device, size_t bufferSize, bool isWritePerFrame, uint32_t dynamicElementCount = 0, bool isStorage = false);
         ~ShaderBuffer();
 
         using Ptr = std::shared_ptr<ShaderBuffer>;
         static Ptr New(Device::Ptr device, size_t bufferSize, bool isWritePerFrame) { return std::make_shared<ShaderBuffer>(device, bufferSize, isWritePerFrame); }
+        // 动态统一缓冲区，每帧存放elementCount个对象数据，绘制时通过动态偏移选择对象
+        static Ptr NewDynamic(Device::Ptr device, size_t elementSize, uint32_t elementCount)
+        {
+            return std::make_shared<ShaderBuffer>(device, elementSize, true, elementCount);
+        }
+        // 存储缓冲区，用于数量较多的对象数组，着色器通过索引读取
+        static Ptr NewStorage(Device::Ptr device, size_t bufferSize, bool isWritePerFrame)
+        {
+            return std::make_shared<ShaderBuffer>(device, bufferSize, isWritePerFrame, 0, true);
+        }
 
     private:
         Device::Ptr mDevice;
-        // 着色器缓冲区
-        std::vector<Buffer::Ptr> mShaderBuffer;
+        // 着色器缓冲区，每帧写入时为常驻映射的环形缓冲区，每帧占用一段对齐的区段
+        Buffer::Ptr mShaderBuffer;
         bool mIsWritePerFrame = false;
+        size_t mDataSize = 0;
+        VkDeviceSize mSliceSize = 0;
+        uint32_t mSliceCount = 0;
+        // 动态统一缓冲区对象
+        bool mIsDynamic = false;
+        VkDeviceSize mElementStride = 0;
+        uint32_t mElementCount = 1;
+        // 存储缓冲区对象
+        bool mIsStorage = false;
 
     private:
         void CreateShaderBuffer(size_t bufferSize);
@@ -29,5 +48,16 @@ namespace vk
 
         void WriteData(uint32_t currentIndex, void *data);
         void AllWriteData(void *data);
+        // 读取着色器写入的每帧数据，需要在该帧的围栏触发后调用
+        void ReadData(uint32_t currentIndex, void *data);
+        void WriteElementData(uint32_t currentIndex, uint32_t elementIndex, void *data);
+        void AllWriteElementData(uint32_t elementIndex, void *data);
+
+        VkDeviceSize GetOffset(uint32_t currentIndex) { return mIsWritePerFrame ? mSliceSize * currentIndex : 0; }
+        VkDeviceSize GetSliceSize() { return mSliceSize; }
+        uint32_t GetDynamicOffset(uint32_t elementIndex) { return static_cast<uint32_t>(mElementStride * elementIndex); }
+        uint32_t GetElementCount() { return mElementCount; }
+        bool IsDynamic() { return mIsDynamic; }
+        bool IsStorage() { return mIsStorage; }
     };
 } // namespace vk
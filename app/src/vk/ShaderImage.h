@@ -10,6 +10,8 @@ namespace vk
     {
     public:
         ShaderImage(Device::Ptr device, uint32_t width, uint32_t height, bool isWritePerFrame);
+        // 指定格式与mip数量，用于预先生成mip的压缩纹理
+        ShaderImage(Device::Ptr device, uint32_t width, uint32_t height, VkFormat format, uint32_t mipLevels, bool isWritePerFrame);
         ~ShaderImage();
 
         using Ptr = std::shared_ptr<ShaderImage>;
@@ -17,6 +19,10 @@ namespace vk
         {
             return std::make_shared<ShaderImage>(device, width, height, isWritePerFrame);
         }
+        static Ptr New(Device::Ptr device, uint32_t width, uint32_t height, VkFormat format, uint32_t mipLevels, bool isWritePerFrame)
+        {
+            return std::make_shared<ShaderImage>(device, width, height, format, mipLevels, isWritePerFrame);
+        }
 
     private:
         Device::Ptr mDevice;
@@ -27,13 +33,17 @@ namespace vk
         bool mIsWritePerFrame = false;
 
     private:
-        void CreateShaderImage(uint32_t width, uint32_t height);
+        void CreateShaderImage(uint32_t width, uint32_t height, VkFormat format, uint32_t mipLevels);
         void CreateShaderSampler();
 
     public:
-        void WriteDescriptorSet(std::vector<DescriptorSet::Ptr> descriptorSetList, uint32_t dstBinding);
+        // dstArrayElement为纹理数组中的位置
+        void WriteDescriptorSet(std::vector<DescriptorSet::Ptr> descriptorSetList, uint32_t dstBinding, uint32_t dstArrayElement = 0);
+        // 只更新currentIndex帧的描述符，用于运行时替换纹理，调用时该帧的描述符不能正在被使用
+        void WriteDescriptorSet(uint32_t currentIndex, std::vector<DescriptorSet::Ptr> descriptorSetList, uint32_t dstBinding, uint32_t dstArrayElement = 0);
 
         bool WriteData(uint32_t currentIndex, void *data);
         bool AllWriteData(void *data);
+        bool AllWriteCompressedData(const uint8_t *data, const std::vector<TextureCompressor::MipLevel> &mipLevelList);
     };
 } // namespace vk
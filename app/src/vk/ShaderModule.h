@@ -27,5 +27,7 @@ namespace vk
     public:
         VkShaderModule GetShaderModule() { return mShaderModule; }
         VkShaderStageFlagBits GetShaderStage() { return mShaderStage; }
+        // 着色器文件不存在或无法创建时为false
+        bool IsValid() { return mShaderModule != nullptr; }
     };
 } // namespace vk
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace vk
+{
+    /**
+     * @brief 纹理块压缩编码器
+     * 在CPU上把RGBA8图像编码为BC1或BC3，并预先生成完整的mip链，mip在线性空间中按2x2平均缩小
+     * 只依赖标准库，不需要Vulkan设备，离线烘焙工具直接编译此文件
+     * 颜色数据按sRGB处理，BC1只使用四色模式，不保留透明度
+     * RGBA8不压缩，只生成mip链，用于没有烘焙文件的纹理流送
+     */
+    class TextureCompressor
+    {
+    public:
+        enum class Format : uint32_t
+        {
+            BC1,
+            BC3,
+            RGBA8,
+        };
+        // 一个mip级别，偏移为相对数据开头的字节数
+        struct MipLevel
+        {
+            uint32_t Width;
+            uint32_t Height;
+            uint64_t Offset;
+            uint64_t Size;
+        };
+        struct CompressedImage
+        {
+            Format ImageFormat = Format::BC1;
+            uint32_t Width = 0;
+            uint32_t Height = 0;
+            std::vector<MipLevel> MipLevelList;
+            // 所有mip级别按从大到小依次紧密排列
+            std::vector<uint8_t> Data;
+        };
+
+    private:
+        // 编码4x4像素块，像素按行排列，每个像素4字节
+        static void CompressColorBlock(const uint8_t *pixel, uint8_t *block);
+        static void CompressAlphaBlock(const uint8_t *pixel, uint8_t *block);
+        // 编码一个mip级别，边缘不足4像素的块重复边缘像素
+        static void CompressLevel(const uint8_t *rgba, uint32_t width, uint32_t height, Format format, uint8_t *data);
+        // 从上一级的线性颜色生成下一级，奇数尺寸时边缘像素重复使用
+        static void GenerateMipLevel(const std::vector<float> &srcLinear, uint32_t srcWidth, uint32_t srcHeight, std::vector<float> *dstLinear);
+        static void LinearToRgba(const std::vector<float> &linear, std::vector<uint8_t> *rgba);
+
+    public:
+        // 压缩格式为4x4块的字节数，RGBA8为单个像素的字节数
+        static uint32_t GetBlockSize(Format format) { return format == Format::BC1 ? 8 : format == Format::BC3 ? 16 : 4; }
+        static uint64_t GetLevelSize(Format format, uint32_t width, uint32_t height)
+        {
+            if (format == Format::RGBA8)
+            {
+                return static_cast<uint64_t>(width) * height * 4;
+            }
+            return static_cast<uint64_t>((width + 3) / 4) * ((height + 3) / 4) * GetBlockSize(format);
+        }
+        static uint32_t GetMipLevelCount(uint32_t width, uint32_t height);
+        // 任意像素的透明度小于255时需要BC3
+        static bool HasAlpha(const uint8_t *rgba, uint32_t width, uint32_t height);
+        static CompressedImage Compress(const uint8_t *rgba, uint32_t width, uint32_t height, Format format, bool isGenerateMip = true);
+    };
+} // namespace vk
@@ -0,0 +1,203 @@
+#pragma once
+#include "Origin.h"
+#include "Device.h"
+#include "Image.h"
+#include "ShaderImage.h"
+#include "JobSystem.h"
+#include "MappedFile.h"
+#include "DdsFile.h"
+
+namespace vk
+{
+    /**
+     * @brief 纹理管理器
+     * 纹理按文件路径注册，注册时不解码，通过句柄共享同一个着色器图像
+     * Get在调用线程上同步解码并上传，Request在解码线程上异步解码，Update在主线程上把解码结果记录到上传批次
+     * 上传批次完成后纹理变为就绪，就绪前使用者继续使用占位纹理
+     * 设备支持BC压缩且存在离线烘焙的DDS文件时，映射该文件直接上传所有mip级别，不再解码与生成mip
+     *
+     * Request加载的纹理参与流送，系统内存中保留完整的mip链，显存中只保留从常驻级别开始的级别
+     * 首次只上传mip尾，之后按着色器反馈的需要级别逐步换入更精细的级别，超出预算时按最近可见的帧淘汰
+     * 常驻级别改变时创建新尺寸的图像并从系统内存上传，上传完成后替换，使用者根据版本号更新描述符
+     */
+    class TextureManager
+    {
+    public:
+        using Handle = uint32_t;
+        static constexpr Handle mInvalidHandle = UINT32_MAX;
+
+        enum class State
+        {
+            Unloaded,
+            Decoding,
+            Uploading,
+            Ready,
+            Failed,
+        };
+
+    public:
+        TextureManager(Device::Ptr device, uint32_t decodeThreadCount);
+        ~TextureManager();
+
+        using Ptr = std::shared_ptr<TextureManager>;
+        static Ptr New(Device::Ptr device, uint32_t decodeThreadCount = std::max(1u, std::thread::hardware_concurrency() / 2))
+        {
+            return std::make_shared<TextureManager>(device, decodeThreadCount);
+        }
+
+    private:
+        struct Texture
+        {
+            std::string FilePath;
+            // 不含路径与扩展名的文件名，与网格或材质名称对应
+            std::string Name;
+            ShaderImage::Ptr Image;
+            State TextureState = State::Unloaded;
+            // 上传批次编号
+            uint64_t UploadTicket = 0;
+            // 图像每次替换时加一
+            uint32_t Version = 0;
+
+            // 流送纹理的完整mip链，数据在烘焙文件的映射或解码后生成的内存中
+            bool IsStreamed = false;
+            TextureCompressor::Format ImageFormat = TextureCompressor::Format::RGBA8;
+            std::vector<TextureCompressor::MipLevel> MipLevelList;
+            MappedFile::Ptr File;
+            std::vector<uint8_t> LevelData;
+            const uint8_t *Data = nullptr;
+            // mip尾始终常驻，图像第0级对应完整mip链的ResidentLevel级
+            uint32_t TailLevel = 0;
+            uint32_t ResidentLevel = 0;
+            // 着色器反馈需要的最精细级别，以及最近一次可见的帧
+            uint32_t DesiredLevel = 0;
+            uint64_t LastVisibleFrame = 0;
+            // 正在上传的新图像
+            ShaderImage::Ptr PendingImage;
+            uint32_t PendingLevel = 0;
+            uint64_t PendingTicket = 0;
+        };
+        // 解码线程的输出，烘焙纹理只映射文件，Info为空
+        struct DecodeResult
+        {
+            Handle TextureHandle = mInvalidHandle;
+            Image::ImageInfo Info{};
+            MappedFile::Ptr CompressedFile;
+            TextureCompressor::CompressedImage CompressedInfo{};
+            const uint8_t *CompressedData = nullptr;
+            bool IsStreamed = false;
+            float DecodeTime = 0;
+        };
+        // 已提交的异步上传批次，完成时计入上传吞吐量
+        struct UploadBatch
+        {
+            uint64_t Ticket;
+            uint64_t Bytes;
+            std::chrono::steady_clock::time_point StartTime;
+        };
+        // 被替换的图像，之前的帧可能仍在使用，到ReleaseFrame时释放
+        struct RetiredImage
+        {
+            ShaderImage::Ptr Image;
+            uint64_t Memory;
+            uint64_t ReleaseFrame;
+        };
+
+    private:
+        Device::Ptr mDevice;
+        std::vector<Texture> mTextureList;
+        std::map<std::string, Handle> mPathMap;
+        std::map<std::string, Handle> mNameMap;
+        // 已解码等待上传的结果
+        std::mutex mDecodeMutex;
+        std::vector<DecodeResult> mDecodeResultList;
+        // 正在上传的纹理
+        std::vector<Handle> mUploadingList;
+        // 统计，耗时单位毫秒，上传只统计Update提交的异步批次，耗时从写入暂存内存到批次完成，完成在下一次Update时才被发现
+        uint32_t mDecodeCount = 0;
+        uint32_t mCompressedCount = 0;
+        // 已上传纹理占用的显存估计，包含mip，不含流送纹理
+        uint64_t mTextureMemory = 0;
+        uint64_t mDecodeBytes = 0;
+        float mDecodeTime = 0;
+        uint64_t mUploadBytes = 0;
+        float mUploadTime = 0;
+        uint64_t mBatchUploadBytes = 0;
+        std::deque<UploadBatch> mUploadBatchList;
+        std::chrono::steady_clock::time_point mLastUploadCompleteTime;
+
+        // 流送，预算约束流送纹理的目标级别，换入换出期间新旧图像同时占用显存
+        uint64_t mFrameNumber = 1;
+        uint64_t mStreamingBudget = 64ull * 1024 * 1024;
+        // 每帧换入的最大字节数，至少换入一个纹理
+        uint64_t mStreamingBytesPerFrame = 8ull * 1024 * 1024;
+        // 尺寸不大于该值的级别属于mip尾
+        static constexpr uint32_t mTailSize = 64;
+        std::vector<RetiredImage> mRetiredImageList;
+        uint64_t mStreamingMemory = 0;
+        uint32_t mStreamInCount = 0;
+        uint32_t mStreamOutCount = 0;
+        uint64_t mStreamInBytes = 0;
+
+        // 解码线程，析构时最先销毁，等待剩余的解码任务
+        JobSystem::Counter mDecodeCounter;
+        JobSystem::Ptr mDecodeJobSystem;
+
+    private:
+        static DecodeResult Decode(Handle handle, std::string filePath, bool isCompressedSupported, bool isStreamed);
+        // 打开烘焙文件，不存在或无法解析时返回false
+        static bool OpenCompressedFile(std::string filePath, DecodeResult *decodeResult);
+        bool Upload(DecodeResult *decodeResult);
+        bool UploadStreamed(DecodeResult *decodeResult);
+        // 从系统内存中的mip链创建只包含baseLevel及之后级别的图像，传输记录到调用方的上传批次
+        ShaderImage::Ptr CreateLevelImage(Texture &texture, uint32_t baseLevel);
+        // 从baseLevel到最后一级占用的显存
+        static uint64_t GetLevelMemory(const Texture &texture, uint32_t baseLevel);
+        // 检查换入换出的上传是否完成，释放不再使用的图像
+        void UpdateResidency();
+        // 按反馈与预算确定需要改变常驻级别的流送纹理及其目标级别
+        void PlanStreaming(std::vector<std::pair<Handle, uint32_t>> *changeList);
+
+    public:
+        // 注册纹理文件，同一路径返回同一句柄
+        Handle Register(std::string filePath);
+        // 按名称查找已注册的纹理，不解码，找不到时返回mInvalidHandle
+        Handle Find(std::string name);
+        // 获取着色器图像，未加载时同步解码并上传，异步加载未完成或失败时返回空
+        ShaderImage::Ptr Get(Handle handle);
+        // 提交异步解码，加载的纹理参与流送
+        void Request(Handle handle);
+        // 在主线程上每帧调用，上传已解码的纹理、检查上传是否完成并按反馈换入换出mip级别
+        void Update();
+        // 记录着色器反馈的需要级别，level为完整mip链中的级别，在本帧的Update之前调用
+        void ReportFeedback(Handle handle, uint32_t level);
+        State GetState(Handle handle) { return handle < mTextureList.size() ? mTextureList[handle].TextureState : State::Failed; }
+        bool IsReady(Handle handle) { return GetState(handle) == State::Ready; }
+        // 图像替换后版本号改变，需要重新写入描述符
+        uint32_t GetVersion(Handle handle) { return handle < mTextureList.size() ? mTextureList[handle].Version : 0; }
+        // 当前图像第0级对应的完整mip链级别，非流送纹理为0
+        uint32_t GetResidentLevel(Handle handle) { return handle < mTextureList.size() ? mTextureList[handle].ResidentLevel : 0; }
+        bool IsStreamed(Handle handle) { return handle < mTextureList.size() && mTextureList[handle].IsStreamed; }
+
+        uint32_t GetTextureCount() { return mTextureList.size(); }
+        // 实际解码的文件数量，包括压缩纹理
+        uint32_t GetDecodeCount() { return mDecodeCount; }
+        uint32_t GetCompressedCount() { return mCompressedCount; }
+        uint64_t GetTextureMemory() { return mTextureMemory; }
+        // 尚未就绪的异步加载数量
+        uint32_t GetPendingCount();
+        // 解码与上传吞吐量，单位MB/s
+        float GetDecodeSpeed() { return mDecodeTime > 0 ? mDecodeBytes / 1048576.0f / (mDecodeTime / 1000.0f) : 0; }
+        float GetUploadSpeed() { return mUploadTime > 0 ? mUploadBytes / 1048576.0f / (mUploadTime / 1000.0f) : 0; }
+
+        // 离线烘焙文件与源文件相同路径，加上.dds后缀
+        static std::string GetBakedPath(std::string filePath) { return filePath + ".dds"; }
+
+        void SetStreamingBudget(uint64_t budget) { mStreamingBudget = budget; }
+        uint64_t GetStreamingBudget() { return mStreamingBudget; }
+        // 流送纹理实际占用的显存，包括正在上传与等待释放的图像
+        uint64_t GetStreamingMemory() { return mStreamingMemory; }
+        uint32_t GetStreamInCount() { return mStreamInCount; }
+        uint32_t GetStreamOutCount() { return mStreamOutCount; }
+        uint64_t GetStreamInBytes() { return mStreamInBytes; }
+    };
+} // namespace vk
@@ -0,0 +1,108 @@
+#pragma once
+#include "Origin.h"
+#include "MemoryAllocator.h"
+
+namespace vk
+{
+    class Device;
+
+    /**
+     * @brief 上传器
+     * 将多次缓冲区与图像传输记录到同一个命令缓冲区，一次提交并通过围栏等待，暂存内存在围栏触发后回收
+     * 存在专用传输队列时，传输命令先在传输队列上执行，图形队列通过信号等待后再执行获取所有权与生成mip等命令
+     */
+    class Uploader
+    {
+    public:
+        // 暂存内存区段
+        struct StagingRange
+        {
+            VkBuffer Buffer = nullptr;
+            VkDeviceSize Offset = 0;
+            void *MappedData = nullptr;
+        };
+
+    public:
+        Uploader(Device *device, VkDeviceSize stagingPageSize);
+        ~Uploader();
+
+        using Ptr = std::shared_ptr<Uploader>;
+        static Ptr New(Device *device, VkDeviceSize stagingPageSize = 8 * 1024 * 1024)
+        {
+            return std::make_shared<Uploader>(device, stagingPageSize);
+        }
+
+    private:
+        // 暂存内存页
+        struct StagingPage
+        {
+            VkBuffer Buffer = nullptr;
+            MemoryAllocator::Allocation Memory{};
+            VkDeviceSize Size = 0;
+            VkDeviceSize Used = 0;
+        };
+        // 上传批次
+        struct Batch
+        {
+            VkCommandBuffer CommandBuffer = nullptr;
+            VkFence Fence = nullptr;
+            // 传输队列命令缓冲区与完成信号
+            VkCommandBuffer TransferCommandBuffer = nullptr;
+            VkSemaphore TransferSemaphore = nullptr;
+            bool IsTransferRecording = false;
+            uint64_t Ticket = 0;
+            std::vector<StagingPage> StagingPageList;
+        };
+
+    private:
+        Device *mDevice = nullptr;
+        VkDeviceSize mStagingPageSize = 0;
+        // 命令池
+        VkCommandPool mCommandPool = nullptr;
+        VkCommandPool mTransferCommandPool = nullptr;
+        // 正在录制的批次
+        std::unique_ptr<Batch> mRecordingBatch;
+        uint32_t mRecordingDepth = 0;
+        // 已提交等待完成的批次
+        std::vector<std::unique_ptr<Batch>> mSubmittedBatchList;
+        // 可复用的批次与暂存内存页
+        std::vector<std::unique_ptr<Batch>> mIdleBatchList;
+        std::vector<StagingPage> mIdleStagingPageList;
+        // 批次编号
+        uint64_t mNextTicket = 1;
+        // 统计
+        uint32_t mSubmitCount = 0;
+        uint32_t mTransferSubmitCount = 0;
+        VkDeviceSize mStagingBytes = 0;
+
+    private:
+        void CreateCommandPool();
+        bool StartBatch();
+        bool CreateStagingPage(VkDeviceSize size, StagingPage *stagingPage);
+        void DestroyStagingPage(StagingPage *stagingPage);
+        void RecycleBatch(std::unique_ptr<Batch> batch);
+
+    public:
+        // 开始批次，可嵌套，最外层End时提交
+        bool Begin();
+        // 结束批次，最外层时提交并返回批次编号，否则返回0
+        bool End(uint64_t *ticket);
+        // 当前批次的图形队列命令缓冲区
+        VkCommandBuffer GetCommandBuffer();
+        // 当前批次的传输队列命令缓冲区，没有专用传输队列时与图形队列命令缓冲区相同
+        VkCommandBuffer GetTransferCommandBuffer();
+        // 将数据拷贝到当前批次的暂存内存
+        bool WriteStaging(const void *data, VkDeviceSize size, StagingRange *stagingRange);
+
+        bool Wait(uint64_t ticket);
+        bool WaitAll();
+        bool IsComplete(uint64_t ticket);
+        // 回收已完成的批次
+        void Collect();
+
+        bool IsRecording() { return mRecordingDepth > 0; }
+        uint32_t GetSubmitCount() { return mSubmitCount; }
+        uint32_t GetTransferSubmitCount() { return mTransferSubmitCount; }
+        VkDeviceSize GetStagingBytes() { return mStagingBytes; }
+    };
+} // namespace vk
@@ -6,18 +6,25 @@ layout(set = 0, binding = 10) uniform CameraSpaceLayout {
     mat4 InverseViewMat;//逆转视图矩阵
 } CameraSpace;
 
-layout(set = 0, binding = 13) uniform SpotLightLayout {
+struct SpotLightLayout {
     vec3 Position;//光点源位置
     float Intensity;//点光源强度
     vec4 Color;//点光源颜色
     float Size;//点光源大小
-} SpotLight;
+};
+
+layout(std430, set = 0, binding = 13) readonly buffer SpotLightListLayout {
+    SpotLightLayout SpotLightS[];//全部点光源，按实例索引读取
+} SpotLightList;
 
 layout(location = 0) in vec2 inPosition;
 
 layout(location = 0) out vec2 outOffset;
+layout(location = 1) flat out vec4 outColor;
 
 void main() {
+    SpotLightLayout SpotLight = SpotLightList.SpotLightS[gl_InstanceIndex];
+
     vec3 CameraRightWorld = vec3(CameraSpace.ViewMat[0][0], CameraSpace.ViewMat[1][0], CameraSpace.ViewMat[2][0]);
     vec3 CameraUpWorld = vec3(CameraSpace.ViewMat[0][1], CameraSpace.ViewMat[1][1], CameraSpace.ViewMat[2][1]);
 
@@ -26,4 +33,5 @@ void main() {
     gl_Position = CameraSpace.ProjectionMat * CameraSpace.ViewMat * vec4(PositionWorld, 1);
 
     outOffset = inPosition;
+    outColor = SpotLight.Color;
 }
@@ -1,6 +1,15 @@
 #version 450
 
-layout(set = 0, binding = 0) uniform sampler2D Image;
+#ifdef NON_UNIFORM_TEXTURE_INDEX
+#extension GL_EXT_nonuniform_qualifier : require
+//多绘制间接中各绘制的纹理索引不同，不是动态一致的
+#define TEXTURE_IMAGE ImageList[nonuniformEXT(inTextureIndex)]
+#else
+//不支持非一致索引时每个绘制绑定各自的描述符，纹理在第一个元素
+#define TEXTURE_IMAGE ImageList[0]
+#endif
+
+layout(set = 0, binding = 0) uniform sampler2D ImageList[16];//纹理数组
 
 layout(set = 0, binding = 10) uniform CameraSpaceLayout {
     mat4 ProjectionMat;//投影矩阵
@@ -22,16 +31,31 @@ layout(set = 0, binding = 11) uniform IlluminationLayout {
     int SpotLightCount;//点光源数
 } Illumination;
 
+#ifdef TEXTURE_FEEDBACK
+//片段着色器写入存储缓冲区需要设备支持fragmentStoresAndAtomics
+layout(std430, set = 0, binding = 15) buffer TextureFeedbackLayout {
+    uint MinLevelS[16];//每个纹理需要的最精细级别，加上偏移16
+} TextureFeedback;
+#endif
+
 layout(location = 0) in vec4 inColor;
 layout(location = 1) in vec2 inUV;
 layout(location = 2) in vec3 inVertexPos;
 layout(location = 3) in vec3 inNormalPos;
+layout(location = 4) flat in uint inTextureIndex;
 
 layout(location = 0) out vec4 outColor;
 
 void main() {
     //纹理
-    vec4 Texture = texture(Image, inUV);
+    vec4 Texture = texture(TEXTURE_IMAGE, inUV);
+#ifdef TEXTURE_FEEDBACK
+    //纹理流送反馈，级别在一致控制流中查询，导数才有定义，每8x8像素取一个像素记录，级别相对当前图像可以为负
+    float Lod = textureQueryLod(TEXTURE_IMAGE, inUV).y;
+    if(((uint(gl_FragCoord.x) | uint(gl_FragCoord.y)) & 7u) == 0u) {
+        atomicMin(TextureFeedback.MinLevelS[inTextureIndex], uint(clamp(floor(Lod) + 16.0, 0.0, 31.0)));
+    }
+#endif
 
     //环境光
     vec3 AmbientLight = Illumination.AmbientLightColor.xyz * Illumination.AmbientLightIntensity;
@@ -10,6 +10,14 @@ layout(set = 0, binding = 12) uniform ModelSpaceLayout {
     mat4 ModelMat;//模型空间矩阵
 } ModelSpace;
 
+struct DrawDataLayout {
+    uint TextureIndex;//纹理数组索引
+};
+
+layout(std430, set = 0, binding = 14) readonly buffer DrawDataListLayout {
+    DrawDataLayout DrawDataS[];//每个绘制的数据，按firstInstance读取
+} DrawDataList;
+
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inNormal;
 layout(location = 2) in vec4 inColor;
@@ -19,6 +27,7 @@ layout(location = 0) out vec4 outColor;
 layout(location = 1) out vec2 outUV;
 layout(location = 2) out vec3 outVertexPos;
 layout(location = 3) out vec3 outNormalPos;
+layout(location = 4) flat out uint outTextureIndex;
 
 void main() {
     //顶点在视图中的位置
@@ -34,4 +43,5 @@ void main() {
     //输出
     outColor = inColor;
     outUV = inUV;
+    outTextureIndex = DrawDataList.DrawDataS[gl_InstanceIndex].TextureIndex;
 }
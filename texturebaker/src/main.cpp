@@ -0,0 +1,128 @@
+#define STB_IMAGE_STATIC
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include "vk/TextureCompressor.h"
+#include "vk/DdsFile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+// 烘焙参数
+struct BakeOption
+{
+    // 为true时按透明度自动选择BC1或BC3
+    bool IsAutoFormat = true;
+    vk::TextureCompressor::Format ImageFormat = vk::TextureCompressor::Format::BC1;
+    bool IsGenerateMip = true;
+};
+
+// 输出文件与源文件相同路径，加上.dds后缀，与程序查找烘焙文件的规则一致
+bool BakeTexture(std::string filePath, const BakeOption &option, std::mutex *printMutex)
+{
+    std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+    // 源文件整体读入，哈希写入烘焙文件，程序据此判断烘焙文件是否过期
+    std::vector<uint8_t> SourceData;
+    {
+        std::ifstream File(filePath, std::ios::binary | std::ios::ate);
+        if (File.is_open())
+        {
+            SourceData.resize(static_cast<size_t>(File.tellg()));
+            File.seekg(0);
+            File.read(reinterpret_cast<char *>(SourceData.data()), SourceData.size());
+        }
+    }
+    int Width = 0;
+    int Height = 0;
+    uint8_t *Data = SourceData.empty() ? nullptr : stbi_load_from_memory(SourceData.data(), static_cast<int>(SourceData.size()), &Width, &Height, nullptr, STBI_rgb_alpha);
+    if (Data == nullptr)
+    {
+        std::lock_guard<std::mutex> Lock(*printMutex);
+        printf("Failed to open image: %s\n", filePath.c_str());
+        return false;
+    }
+    vk::TextureCompressor::Format ImageFormat = option.ImageFormat;
+    if (option.IsAutoFormat)
+    {
+        ImageFormat = vk::TextureCompressor::HasAlpha(Data, Width, Height) ? vk::TextureCompressor::Format::BC3 : vk::TextureCompressor::Format::BC1;
+    }
+    vk::TextureCompressor::CompressedImage Image = vk::TextureCompressor::Compress(Data, Width, Height, ImageFormat, option.IsGenerateMip);
+    stbi_image_free(Data);
+    std::string OutputFilePath = filePath + ".dds";
+    bool IsSave = vk::DdsFile::Save(OutputFilePath, Image, vk::ContentHash::Hash(SourceData.data(), SourceData.size()));
+    float BakeTime = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::steady_clock::now() - StartTime).count();
+
+    std::lock_guard<std::mutex> Lock(*printMutex);
+    if (!IsSave)
+    {
+        printf("Failed to write baked texture: %s\n", OutputFilePath.c_str());
+        return false;
+    }
+    printf("%s: %dx%d %s, %zu levels, %.2fMB -> %.2fMB, %.2fms\n", OutputFilePath.c_str(), Width, Height,
+           ImageFormat == vk::TextureCompressor::Format::BC1 ? "BC1" : "BC3", Image.MipLevelList.size(),
+           Width * Height * 4 / 1048576.0f, Image.Data.size() / 1048576.0f, BakeTime);
+    //
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    BakeOption Option{};
+    std::vector<std::string> FileList;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--bc1") == 0)
+        {
+            Option.IsAutoFormat = false;
+            Option.ImageFormat = vk::TextureCompressor::Format::BC1;
+        }
+        else if (strcmp(argv[i], "--bc3") == 0)
+        {
+            Option.IsAutoFormat = false;
+            Option.ImageFormat = vk::TextureCompressor::Format::BC3;
+        }
+        else if (strcmp(argv[i], "--no-mip") == 0)
+        {
+            Option.IsGenerateMip = false;
+        }
+        else
+        {
+            FileList.push_back(argv[i]);
+        }
+    }
+    if (FileList.empty())
+    {
+        printf("Usage: %s [--bc1|--bc3] [--no-mip] <image>...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // 每个线程依次领取文件
+    std::atomic<size_t> NextIndex = 0;
+    std::atomic<uint32_t> FailedCount = 0;
+    std::mutex PrintMutex;
+    std::vector<std::thread> ThreadList(std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), FileList.size()));
+    for (auto &&i : ThreadList)
+    {
+        i = std::thread([&]()
+                        {
+                            for (size_t Index = NextIndex++; Index < FileList.size(); Index = NextIndex++)
+                            {
+                                if (!BakeTexture(FileList[Index], Option, &PrintMutex))
+                                {
+                                    FailedCount++;
+                                }
+                            } });
+        //
+    }
+    for (auto &&i : ThreadList)
+    {
+        i.join();
+    }
+    return FailedCount == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}